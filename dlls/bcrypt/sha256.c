@@ -22,6 +22,13 @@
 
 #include "bcrypt_internal.h"
 
+#if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__)) && \
+    (defined(__clang__) || __GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))
+#define USE_SHA_NI
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+
 static DWORD ror(DWORD n, int k) { return (n >> k) | (n << (32-k)); }
 #define Ch(x,y,z)  (z ^ (x & (y ^ z)))
 #define Maj(x,y,z) ((x & y) | (z & (x | y)))
@@ -91,6 +98,102 @@ static void processblock(SHA256_CTX *ctx, const UCHAR *buffer)
     ctx->h[7] += h;
 }
 
+#ifdef USE_SHA_NI
+
+static BOOL sha_ni_supported(void)
+{
+    static int supported = -1;
+    unsigned int eax, ebx, ecx, edx;
+
+    if (supported == -1)
+    {
+        supported = 0;
+        if (__get_cpuid_max(0, NULL) >= 7)
+        {
+            __cpuid(1, eax, ebx, ecx, edx);
+            if ((ecx & (1 << 9)) && (ecx & (1 << 19))) /* SSSE3, SSE4.1 */
+            {
+                __cpuid_count(7, 0, eax, ebx, ecx, edx);
+                supported = !!(ebx & (1 << 29)); /* SHA */
+            }
+        }
+    }
+    return supported;
+}
+
+#define SHA_NI_FUNC __attribute__((target("sha,sse4.1,ssse3")))
+
+static inline SHA_NI_FUNC void sha_ni_rounds4(__m128i *state0, __m128i *state1, __m128i msg, int i)
+{
+    __m128i tmp = _mm_add_epi32(msg, _mm_loadu_si128((const __m128i *)&K[4 * i]));
+
+    *state1 = _mm_sha256rnds2_epu32(*state1, *state0, tmp);
+    *state0 = _mm_sha256rnds2_epu32(*state0, *state1, _mm_shuffle_epi32(tmp, 0x0e));
+}
+
+/* same as processblock() for count consecutive blocks, using the SHA extensions */
+static SHA_NI_FUNC void processblocks_sha_ni(SHA256_CTX *ctx, const UCHAR *buffer, ULONG count)
+{
+    const __m128i bswap = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+    __m128i state0, state1, abef, cdgh, msg0, msg1, msg2, msg3, tmp;
+    int i;
+
+    /* the instructions want the state as ABEF and CDGH */
+    tmp = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *)&ctx->h[0]), 0xb1);
+    state1 = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *)&ctx->h[4]), 0x1b);
+    state0 = _mm_alignr_epi8(tmp, state1, 8);
+    state1 = _mm_blend_epi16(state1, tmp, 0xf0);
+
+    for (; count; count--, buffer += 64)
+    {
+        abef = state0;
+        cdgh = state1;
+
+        msg0 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)buffer), bswap);
+        msg1 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(buffer + 16)), bswap);
+        msg2 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(buffer + 32)), bswap);
+        msg3 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(buffer + 48)), bswap);
+        sha_ni_rounds4(&state0, &state1, msg0, 0);
+        sha_ni_rounds4(&state0, &state1, msg1, 1);
+        sha_ni_rounds4(&state0, &state1, msg2, 2);
+        sha_ni_rounds4(&state0, &state1, msg3, 3);
+
+        for (i = 4; i < 16; i++)
+        {
+            tmp = _mm_add_epi32(_mm_sha256msg1_epu32(msg0, msg1), _mm_alignr_epi8(msg3, msg2, 4));
+            tmp = _mm_sha256msg2_epu32(tmp, msg3);
+            msg0 = msg1;
+            msg1 = msg2;
+            msg2 = msg3;
+            msg3 = tmp;
+            sha_ni_rounds4(&state0, &state1, msg3, i);
+        }
+
+        state0 = _mm_add_epi32(state0, abef);
+        state1 = _mm_add_epi32(state1, cdgh);
+    }
+
+    tmp = _mm_shuffle_epi32(state0, 0x1b);
+    state1 = _mm_shuffle_epi32(state1, 0xb1);
+    _mm_storeu_si128((__m128i *)&ctx->h[0], _mm_blend_epi16(tmp, state1, 0xf0));
+    _mm_storeu_si128((__m128i *)&ctx->h[4], _mm_alignr_epi8(state1, tmp, 8));
+}
+
+#endif /* USE_SHA_NI */
+
+static void processblocks(SHA256_CTX *ctx, const UCHAR *buffer, ULONG count)
+{
+#ifdef USE_SHA_NI
+    if (sha_ni_supported())
+    {
+        processblocks_sha_ni(ctx, buffer, count);
+        return;
+    }
+#endif
+    for (; count; count--, buffer += 64)
+        processblock(ctx, buffer);
+}
+
 static void pad(SHA256_CTX *ctx)
 {
     ULONG64 r = ctx->len % 64;
@@ -101,7 +204,7 @@ static void pad(SHA256_CTX *ctx)
     {
         memset(ctx->buf + r, 0, 64 - r);
         r = 0;
-        processblock(ctx, ctx->buf);
+        processblocks(ctx, ctx->buf, 1);
     }
 
     memset(ctx->buf + r, 0, 56 - r);
@@ -115,7 +218,7 @@ static void pad(SHA256_CTX *ctx)
     ctx->buf[62] = ctx->len >> 8;
     ctx->buf[63] = ctx->len;
 
-    processblock(ctx, ctx->buf);
+    processblocks(ctx, ctx->buf, 1);
 }
 
 void sha256_init(SHA256_CTX *ctx)
@@ -147,10 +250,11 @@ void sha256_update(SHA256_CTX *ctx, const UCHAR *buffer, ULONG len)
         memcpy(ctx->buf + r, p, 64 - r);
         len -= 64 - r;
         p += 64 - r;
-        processblock(ctx, ctx->buf);
+        processblocks(ctx, ctx->buf, 1);
     }
-    for (; len >= 64; len -= 64, p += 64)
-        processblock(ctx, p);
+    processblocks(ctx, p, len / 64);
+    p += len & ~63;
+    len &= 63;
     memcpy(ctx->buf, p, len);
 }
 
@@ -41,6 +41,7 @@ There is still some work to be done:
 #include "winbase.h"
 #include "winerror.h"
 #include "winternl.h"
+#include "winreg.h"
 #include "fci.h"
 #include "zlib.h"
 #include "cabinet.h"
@@ -138,6 +139,18 @@ struct data_block
     cab_UWORD   uncompressed;
 };
 
+#define MAX_COMPRESS_JOBS 8
+
+/* a data block being compressed on a worker thread */
+struct compress_job
+{
+    HANDLE        done;
+    cab_UWORD     compressed;
+    cab_UWORD     uncompressed;
+    unsigned char data_in[CAB_BLOCKMAX];
+    unsigned char data_out[2 * CAB_BLOCKMAX];
+};
+
 typedef struct FCI_Int
 {
   unsigned int       magic;
@@ -185,6 +198,10 @@ typedef struct FCI_Int
   cab_ULONG          folders_data_size;   /* total size of data contained in the current folders */
   TCOMP              compression;
   cab_UWORD        (*compress)(struct FCI_Int *);
+  struct compress_job *jobs;              /* job slots for compressing blocks in parallel */
+  unsigned int       jobs_count;          /* number of job slots, 0 if not set up yet */
+  unsigned int       jobs_first;          /* oldest job still in progress */
+  unsigned int       jobs_pending;        /* number of jobs in progress */
 } FCI_Int;
 
 #define FCI_INT_MAGIC 0xfcfcfc05
@@ -305,14 +322,13 @@ static void free_file( FCI_Int *fci, struct file *file )
     fci->free( file );
 }
 
-/* create a new data block for the data in fci->data_in */
-static BOOL add_data_block( FCI_Int *fci, PFNFCISTATUS status_callback )
+/* store a compressed block in the temp file and account for it */
+static BOOL store_data_block( FCI_Int *fci, const unsigned char *data, cab_UWORD compressed,
+                              cab_UWORD uncompressed, PFNFCISTATUS status_callback )
 {
     int err;
     struct data_block *block;
 
-    if (!fci->cdata_in) return TRUE;
-
     if (fci->data.handle == -1 && !create_temp_file( fci, &fci->data )) return FALSE;
 
     if (!(block = fci->alloc( sizeof(*block) )))
@@ -320,10 +336,10 @@ static BOOL add_data_block( FCI_Int *fci, PFNFCISTATUS status_callback )
         set_error( fci, FCIERR_ALLOC_FAIL, ERROR_NOT_ENOUGH_MEMORY );
         return FALSE;
     }
-    block->uncompressed = fci->cdata_in;
-    block->compressed   = fci->compress( fci );
+    block->uncompressed = uncompressed;
+    block->compressed   = compressed;
 
-    if (fci->write( fci->data.handle, fci->data_out,
+    if (fci->write( fci->data.handle, (void *)data,
                     block->compressed, &err, fci->pv ) != block->compressed)
     {
         set_error( fci, FCIERR_TEMP_FILE, err );
@@ -331,7 +347,6 @@ static BOOL add_data_block( FCI_Int *fci, PFNFCISTATUS status_callback )
         return FALSE;
     }
 
-    fci->cdata_in = 0;
     fci->pending_data_size += sizeof(CFDATA) + fci->ccab.cbReserveCFData + block->compressed;
     fci->cCompressedBytesInFolder += block->compressed;
     fci->cDataBlocks++;
@@ -345,6 +360,140 @@ static BOOL add_data_block( FCI_Int *fci, PFNFCISTATUS status_callback )
     return TRUE;
 }
 
+/* create a new data block for the data in fci->data_in */
+static BOOL add_data_block( FCI_Int *fci, PFNFCISTATUS status_callback )
+{
+    cab_UWORD compressed, uncompressed = fci->cdata_in;
+
+    if (!fci->cdata_in) return TRUE;
+
+    compressed = fci->compress( fci );
+    fci->cdata_in = 0;
+    return store_data_block( fci, fci->data_out, compressed, uncompressed, status_callback );
+}
+
+static cab_UWORD deflate_block( const unsigned char *in, cab_UWORD len, unsigned char *out,
+                                unsigned int out_size, alloc_func zalloc, free_func zfree, void *opaque );
+
+static void *heap_zalloc( void *opaque, unsigned int items, unsigned int size )
+{
+    return HeapAlloc( GetProcessHeap(), 0, items * size );
+}
+
+static void heap_zfree( void *opaque, void *ptr )
+{
+    HeapFree( GetProcessHeap(), 0, ptr );
+}
+
+static DWORD CALLBACK compress_job_proc( void *arg )
+{
+    struct compress_job *job = arg;
+
+    /* the caller's allocation callbacks may not be thread safe, use the process heap */
+    job->compressed = deflate_block( job->data_in, job->uncompressed, job->data_out,
+                                     sizeof(job->data_out), heap_zalloc, heap_zfree, NULL );
+    SetEvent( job->done );
+    return 0;
+}
+
+static unsigned int get_compress_thread_count(void)
+{
+    DWORD count, type, size = sizeof(count);
+    HKEY key;
+
+    if (!RegOpenKeyExW( HKEY_CURRENT_USER, L"Software\\Wine\\Cabinet", 0, KEY_QUERY_VALUE, &key ))
+    {
+        LONG res = RegQueryValueExW( key, L"CompressThreads", NULL, &type, (BYTE *)&count, &size );
+        RegCloseKey( key );
+        if (!res && type == REG_DWORD) return count;
+    }
+    return 1;
+}
+
+/* set up the job slots for compressing blocks in parallel, if that's enabled */
+static BOOL init_compress_jobs( FCI_Int *fci )
+{
+    unsigned int i, count;
+
+    if (fci->jobs_count) return fci->jobs != NULL;
+
+    count = min( max( get_compress_thread_count(), 1 ), MAX_COMPRESS_JOBS );
+    TRACE( "using %u thread(s) to compress data blocks\n", count );
+    fci->jobs_count = count;
+    if (count < 2) return FALSE;
+
+    if (!(fci->jobs = fci->alloc( count * sizeof(*fci->jobs) ))) return FALSE;
+    for (i = 0; i < count; i++)
+    {
+        if (!(fci->jobs[i].done = CreateEventW( NULL, FALSE, FALSE, NULL )))
+        {
+            while (i--) CloseHandle( fci->jobs[i].done );
+            fci->free( fci->jobs );
+            fci->jobs = NULL;
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+static void free_compress_jobs( FCI_Int *fci )
+{
+    unsigned int i;
+
+    if (!fci->jobs) return;
+    for (i = 0; i < fci->jobs_count; i++) CloseHandle( fci->jobs[i].done );
+    fci->free( fci->jobs );
+    fci->jobs = NULL;
+}
+
+/* wait for the oldest job and store its block, errors are only reported if ret is TRUE */
+static BOOL finish_compress_job( FCI_Int *fci, BOOL ret, PFNFCISTATUS status_callback )
+{
+    struct compress_job *job = &fci->jobs[fci->jobs_first];
+
+    WaitForSingleObject( job->done, INFINITE );
+    fci->jobs_first = (fci->jobs_first + 1) % fci->jobs_count;
+    fci->jobs_pending--;
+
+    if (!ret) return FALSE;
+    if (!job->compressed)
+    {
+        set_error( fci, FCIERR_ALLOC_FAIL, ERROR_NOT_ENOUGH_MEMORY );
+        return FALSE;
+    }
+    return store_data_block( fci, job->data_out, job->compressed, job->uncompressed, status_callback );
+}
+
+/* wait for all the jobs in progress, storing their blocks in order */
+static BOOL finish_compress_jobs( FCI_Int *fci, BOOL ret, PFNFCISTATUS status_callback )
+{
+    while (fci->jobs_pending) ret = finish_compress_job( fci, ret, status_callback );
+    return ret;
+}
+
+/* hand the data in fci->data_in over to a worker thread */
+static BOOL queue_data_block( FCI_Int *fci, PFNFCISTATUS status_callback )
+{
+    struct compress_job *job;
+
+    if (fci->jobs_pending == fci->jobs_count && !finish_compress_job( fci, TRUE, status_callback ))
+        return FALSE;
+
+    job = &fci->jobs[(fci->jobs_first + fci->jobs_pending) % fci->jobs_count];
+    memcpy( job->data_in, fci->data_in, fci->cdata_in );
+    job->uncompressed = fci->cdata_in;
+    if (!QueueUserWorkItem( compress_job_proc, job, WT_EXECUTEDEFAULT ))
+    {
+        /* keep the blocks in order */
+        if (!finish_compress_jobs( fci, TRUE, status_callback )) return FALSE;
+        return add_data_block( fci, status_callback );
+    }
+
+    fci->jobs_pending++;
+    fci->cdata_in = 0;
+    return TRUE;
+}
+
 /* add compressed blocks for all the data that can be read from the file */
 static BOOL add_file_data( FCI_Int *fci, char *sourcefile, char *filename, BOOL execute,
                            PFNFCIGETOPENINFO get_open_info, PFNFCISTATUS status_callback )
@@ -352,6 +501,7 @@ static BOOL add_file_data( FCI_Int *fci, char *sourcefile, char *filename, BOOL
     int err, len;
     INT_PTR handle;
     struct file *file;
+    BOOL parallel;
 
     if (!(file = add_file( fci, filename ))) return FALSE;
 
@@ -364,6 +514,11 @@ static BOOL add_file_data( FCI_Int *fci, char *sourcefile, char *filename, BOOL
     }
     if (execute) file->attribs |= _A_EXEC;
 
+    /* Blocks are compressed independently, so full blocks of a file can be
+     * compressed in parallel.  They are still stored in order, and all of
+     * them are done before returning, so the output doesn't change. */
+    parallel = fci->compression == tcompTYPE_MSZIP && init_compress_jobs( fci );
+
     for (;;)
     {
         len = fci->read( handle, fci->data_in + fci->cdata_in,
@@ -373,14 +528,19 @@ static BOOL add_file_data( FCI_Int *fci, char *sourcefile, char *filename, BOOL
         if (len == -1)
         {
             set_error( fci, FCIERR_READ_SRC, err );
-            return FALSE;
+            return finish_compress_jobs( fci, FALSE, status_callback );
         }
         file->size += len;
         fci->cdata_in += len;
-        if (fci->cdata_in == CAB_BLOCKMAX && !add_data_block( fci, status_callback )) return FALSE;
+        if (fci->cdata_in == CAB_BLOCKMAX)
+        {
+            if (!(parallel ? queue_data_block( fci, status_callback )
+                           : add_data_block( fci, status_callback )))
+                return finish_compress_jobs( fci, FALSE, status_callback );
+        }
     }
     fci->close( handle, &err, fci->pv );
-    return TRUE;
+    return finish_compress_jobs( fci, TRUE, status_callback );
 }
 
 static void free_data_block( FCI_Int *fci, struct data_block *block )
@@ -917,30 +1077,37 @@ static void zfree( void *opaque, void *ptr )
     fci->free( ptr );
 }
 
-static cab_UWORD compress_MSZIP( FCI_Int *fci )
+static cab_UWORD deflate_block( const unsigned char *in, cab_UWORD len, unsigned char *out,
+                                unsigned int out_size, alloc_func zalloc, free_func zfree, void *opaque )
 {
     z_stream stream;
 
     stream.zalloc = zalloc;
     stream.zfree  = zfree;
-    stream.opaque = fci;
+    stream.opaque = opaque;
     if (deflateInit2( &stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY ) != Z_OK)
-    {
-        set_error( fci, FCIERR_ALLOC_FAIL, ERROR_NOT_ENOUGH_MEMORY );
         return 0;
-    }
-    stream.next_in   = fci->data_in;
-    stream.avail_in  = fci->cdata_in;
-    stream.next_out  = fci->data_out + 2;
-    stream.avail_out = sizeof(fci->data_out) - 2;
+    stream.next_in   = (unsigned char *)in;
+    stream.avail_in  = len;
+    stream.next_out  = out + 2;
+    stream.avail_out = out_size - 2;
     /* insert the signature */
-    fci->data_out[0] = 'C';
-    fci->data_out[1] = 'K';
+    out[0] = 'C';
+    out[1] = 'K';
     deflate( &stream, Z_FINISH );
     deflateEnd( &stream );
     return stream.total_out + 2;
 }
 
+static cab_UWORD compress_MSZIP( FCI_Int *fci )
+{
+    cab_UWORD ret = deflate_block( fci->data_in, fci->cdata_in, fci->data_out,
+                                   sizeof(fci->data_out), zalloc, zfree, fci );
+
+    if (!ret) set_error( fci, FCIERR_ALLOC_FAIL, ERROR_NOT_ENOUGH_MEMORY );
+    return ret;
+}
+
 
 /***********************************************************************
  *		FCICreate (CABINET.10)
@@ -1723,6 +1890,7 @@ BOOL __cdecl FCIDestroy(HFCI hfci)
     }
 
     close_temp_file( p_fci_internal, &p_fci_internal->data );
+    free_compress_jobs( p_fci_internal );
 
     /* hfci can now be removed */
     p_fci_internal->free(hfci);
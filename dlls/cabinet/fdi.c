@@ -1055,6 +1055,23 @@ struct Ziphuft **t, cab_LONG *m, fdi_decomp_state *decomp_state)
   return y != 0 && g != 1;
 }
 
+/*********************************************************
+ * fdi_copy_match (internal)
+ *
+ * Copies a match within the window.  Matches that don't overlap their own
+ * output are copied in one go, runs of a single byte are filled, and only
+ * real overlapping matches fall back to copying byte by byte.
+ */
+static inline void fdi_copy_match(cab_UBYTE *dest, const cab_UBYTE *src, cab_ULONG len)
+{
+  if (src + len <= dest || dest + len <= src)
+    memcpy(dest, src, len);
+  else if (src + 1 == dest)
+    memset(dest, *src, len);
+  else
+    while (len--) *dest++ = *src++;
+}
+
 /*********************************************************
  * fdi_Zipinflate_codes (internal)
  */
@@ -1066,13 +1083,21 @@ static cab_LONG fdi_Zipinflate_codes(const struct Ziphuft *tl, const struct Ziph
   cab_ULONG w;              /* current window position */
   const struct Ziphuft *t;  /* pointer to table entry */
   cab_ULONG ml, md;         /* masks for bl and bd bits */
-  register cab_ULONG b;     /* bit buffer */
+  register ULONGLONG b;     /* bit buffer */
   register cab_ULONG k;     /* number of bits in bit buffer */
+  cab_UBYTE *in, *inend;    /* input position and end of input */
+  cab_UBYTE *out;           /* output window */
+
+/* same as ZIPNEEDBITS, but working on the local copies */
+#define CODESNEEDBITS(n) {while(k<(n)){b|=((ULONGLONG)*in++)<<k;k+=8;}}
 
   /* make local copies of globals */
   b = ZIP(bb);                       /* initialize bit buffer */
   k = ZIP(bk);
   w = ZIP(window_posn);                       /* initialize window position */
+  in = ZIP(inpos);
+  inend = ZIP(inend);
+  out = CAB(outbuf);
 
   /* inflate the coded data */
   ml = Zipmask[bl];           	/* precompute masks for speed */
@@ -1080,7 +1105,17 @@ static cab_LONG fdi_Zipinflate_codes(const struct Ziphuft *tl, const struct Ziph
 
   for(;;)
   {
-    ZIPNEEDBITS((cab_ULONG)bl)
+    /* A literal/length code, its extra bits, a distance code and its extra
+     * bits take at most 48 bits, so with 57 or more bits in the buffer the
+     * whole symbol can be decoded without refilling. */
+    if (inend - in >= 8)
+      while (k <= 56)
+      {
+        b |= ((ULONGLONG)*in++) << k;
+        k += 8;
+      }
+
+    CODESNEEDBITS((cab_ULONG)bl)
     if((e = (t = tl + (b & ml))->e) > 16)
       do
       {
@@ -1088,11 +1123,11 @@ static cab_LONG fdi_Zipinflate_codes(const struct Ziphuft *tl, const struct Ziph
           return 1;
         ZIPDUMPBITS(t->b)
         e -= 16;
-        ZIPNEEDBITS(e)
+        CODESNEEDBITS(e)
       } while ((e = (t = t->v.t + (b & Zipmask[e]))->e) > 16);
     ZIPDUMPBITS(t->b)
     if (e == 16)                /* then it's a literal */
-      CAB(outbuf)[w++] = (cab_UBYTE)t->v.n;
+      out[w++] = (cab_UBYTE)t->v.n;
     else                        /* it's an EOB or a length */
     {
       /* exit if end of block */
@@ -1100,23 +1135,23 @@ static cab_LONG fdi_Zipinflate_codes(const struct Ziphuft *tl, const struct Ziph
         break;
 
       /* get length of block to copy */
-      ZIPNEEDBITS(e)
-      n = t->v.n + (b & Zipmask[e]);
+      CODESNEEDBITS(e)
+      n = t->v.n + ((cab_ULONG)b & Zipmask[e]);
       ZIPDUMPBITS(e);
 
       /* decode distance of block to copy */
-      ZIPNEEDBITS((cab_ULONG)bd)
+      CODESNEEDBITS((cab_ULONG)bd)
       if ((e = (t = td + (b & md))->e) > 16)
         do {
           if (e == 99)
             return 1;
           ZIPDUMPBITS(t->b)
           e -= 16;
-          ZIPNEEDBITS(e)
+          CODESNEEDBITS(e)
         } while ((e = (t = t->v.t + (b & Zipmask[e]))->e) > 16);
       ZIPDUMPBITS(t->b)
-      ZIPNEEDBITS(e)
-      d = w - t->v.n - (b & Zipmask[e]);
+      CODESNEEDBITS(e)
+      d = w - t->v.n - ((cab_ULONG)b & Zipmask[e]);
       ZIPDUMPBITS(e)
       do
       {
@@ -1124,18 +1159,26 @@ static cab_LONG fdi_Zipinflate_codes(const struct Ziphuft *tl, const struct Ziph
         e = ZIPWSIZE - max(d, w);
         e = min(e, n);
         n -= e;
-        do
-        {
-          CAB(outbuf)[w++] = CAB(outbuf)[d++];
-        } while (--e);
+        fdi_copy_match(out + w, out + d, e);
+        w += e;
+        d += e;
       } while (n);
     }
   }
 
+#undef CODESNEEDBITS
+
+  /* give back the whole bytes still in the bit buffer, so that the globals
+   * only ever hold the bits of a partially consumed byte */
+  in -= k >> 3;
+  k &= 7;
+  b &= Zipmask[k];
+
   /* restore the globals from the locals */
   ZIP(window_posn) = w;              /* restore global window pointer */
-  ZIP(bb) = b;                       /* restore global bit buffer */
+  ZIP(bb) = (cab_ULONG)b;            /* restore global bit buffer */
   ZIP(bk) = k;
+  ZIP(inpos) = in;
 
   /* done */
   return 0;
@@ -1170,13 +1213,22 @@ static cab_LONG fdi_Zipinflate_stored(fdi_decomp_state *decomp_state)
     return 1;                   /* error in compressed data */
   ZIPDUMPBITS(16)
 
-  /* read and output the compressed data */
-  while(n--)
+  if (n > CAB_BLOCKMAX - w)
+    return 1;
+
+  /* read and output the compressed data: first whatever whole bytes are
+   * left in the bit buffer, then the rest straight from the input */
+  while(n && k)
   {
-    ZIPNEEDBITS(8)
     CAB(outbuf)[w++] = (cab_UBYTE)b;
     ZIPDUMPBITS(8)
+    n--;
   }
+  if (ZIP(inpos) > ZIP(inend) || n > (cab_ULONG)(ZIP(inend) - ZIP(inpos)))
+    return 1;                   /* block extends past the end of the input */
+  memcpy(CAB(outbuf) + w, ZIP(inpos), n);
+  ZIP(inpos) += n;
+  w += n;
 
   /* restore the globals from the locals */
   ZIP(window_posn) = w;              /* restore global window pointer */
@@ -1410,6 +1462,7 @@ static int ZIPfdi_decomp(int inlen, int outlen, fdi_decomp_state *decomp_state)
   TRACE("(inlen == %d, outlen == %d)\n", inlen, outlen);
 
   ZIP(inpos) = CAB(inbuf);
+  ZIP(inend) = CAB(inbuf) + inlen;
   ZIP(bb) = ZIP(bk) = ZIP(window_posn) = 0;
   if(outlen > ZIPWSIZE)
     return DECR_DATAFORMAT;
@@ -1530,14 +1583,15 @@ static int QTMfdi_decomp(int inlen, int outlen, fdi_decomp_state *decomp_state)
         if (copy_length < match_length) {
           match_length -= copy_length;
           window_posn += copy_length;
-          while (copy_length-- > 0) *rundest++ = *runsrc++;
+          fdi_copy_match(rundest, runsrc, copy_length);
+          rundest += copy_length;
           runsrc = window;
         }
       }
       window_posn += match_length;
 
       /* copy match data - no worries about destination wraps */
-      while (match_length-- > 0) *rundest++ = *runsrc++;
+      fdi_copy_match(rundest, runsrc, match_length);
     }
   } /* while (togo > 0) */
 
@@ -1768,14 +1822,15 @@ static int LZXfdi_decomp(int inlen, int outlen, fdi_decomp_state *decomp_state)
               if (copy_length < match_length) {
                 match_length -= copy_length;
                 window_posn += copy_length;
-                while (copy_length-- > 0) *rundest++ = *runsrc++;
+                fdi_copy_match(rundest, runsrc, copy_length);
+                rundest += copy_length;
                 runsrc = window;
               }
             }
             window_posn += match_length;
 
             /* copy match data - no worries about destination wraps */
-            while (match_length-- > 0) *rundest++ = *runsrc++;
+            fdi_copy_match(rundest, runsrc, match_length);
           }
         }
         break;
@@ -1857,14 +1912,15 @@ static int LZXfdi_decomp(int inlen, int outlen, fdi_decomp_state *decomp_state)
               if (copy_length < match_length) {
                 match_length -= copy_length;
                 window_posn += copy_length;
-                while (copy_length-- > 0) *rundest++ = *runsrc++;
+                fdi_copy_match(rundest, runsrc, copy_length);
+                rundest += copy_length;
                 runsrc = window;
               }
             }
             window_posn += match_length;
 
             /* copy match data - no worries about destination wraps */
-            while (match_length-- > 0) *rundest++ = *runsrc++;
+            fdi_copy_match(rundest, runsrc, match_length);
           }
         }
         break;
@@ -941,6 +941,276 @@ static void test_FDICopy(void)
     FDIDestroy(hfdi);
 }
 
+static struct mem_data mszip_cab;
+static char mszip_output[32];
+static UINT mszip_output_size;
+
+static INT_PTR CDECL fdi_mszip_open(char *name, int oflag, int pmode)
+{
+    struct mem_data *data;
+
+    data = HeapAlloc(GetProcessHeap(), 0, sizeof(*data));
+    if (!data) return -1;
+    *data = mszip_cab;
+    return (INT_PTR)data;
+}
+
+static UINT CDECL fdi_mszip_write(INT_PTR hf, void *pv, UINT cb)
+{
+    if (mszip_output_size + cb > sizeof(mszip_output)) return -1;
+    memcpy(mszip_output + mszip_output_size, pv, cb);
+    mszip_output_size += cb;
+    return cb;
+}
+
+static INT_PTR CDECL fdi_mszip_notify(FDINOTIFICATIONTYPE fdint, FDINOTIFICATION *info)
+{
+    switch (fdint)
+    {
+    case fdintCOPY_FILE:
+        return 0x12345678;
+    case fdintCLOSE_FILE_INFO:
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+static void test_FDICopy_mszip(void)
+{
+    static const char expected[] = "Hello World!";
+    static const struct
+    {
+        BYTE data[32];
+        USHORT size;
+        BOOL valid;
+    }
+    tests[] =
+    {
+        /* a single final stored block */
+        { {'C','K',0x01,0x0c,0x00,0xf3,0xff,'H','e','l','l','o',' ','W','o','r','l','d','!'}, 19, TRUE },
+        /* the stored block is longer than the data block */
+        { {'C','K',0x01,0x0c,0x00,0xf3,0xff,'H','e','l','l','o',' '}, 13, FALSE },
+        { {'C','K',0x01,0x0c,0x00,0xf3,0xff}, 7, FALSE },
+        /* length and its complement don't match */
+        { {'C','K',0x01,0x0c,0x00,0xf2,0xff,'H','e','l','l','o',' ','W','o','r','l','d','!'}, 19, FALSE },
+        /* missing MSZIP signature */
+        { {'C','X',0x01,0x0c,0x00,0xf3,0xff,'H','e','l','l','o',' ','W','o','r','l','d','!'}, 19, FALSE },
+        /* invalid block type */
+        { {'C','K',0x07,0x0c,0x00,0xf3,0xff,'H','e','l','l','o',' ','W','o','r','l','d','!'}, 19, FALSE },
+    };
+    char memory[] = "memory\\", block[] = "block";
+    struct CFHEADER *header;
+    struct CFFOLDER *folder;
+    struct CFFILE *file;
+    struct CFDATA *data;
+    char *name;
+    BYTE cab[256];
+    unsigned int i;
+    HFDI hfdi;
+    ERF erf;
+    BOOL ret;
+
+    for (i = 0; i < ARRAY_SIZE(tests); i++)
+    {
+        memset(cab, 0, sizeof(cab));
+        header = (struct CFHEADER *)cab;
+        folder = (struct CFFOLDER *)(header + 1);
+        file = (struct CFFILE *)(folder + 1);
+        name = (char *)(file + 1);
+        data = (struct CFDATA *)(name + sizeof("file.dat"));
+
+        memcpy(header->signature, "MSCF", 4);
+        header->cbCabinet = (BYTE *)(data + 1) + tests[i].size - cab;
+        header->coffFiles = (BYTE *)file - cab;
+        header->versionMinor = 3;
+        header->versionMajor = 1;
+        header->cFolders = 1;
+        header->cFiles = 1;
+        folder->coffCabStart = (BYTE *)data - cab;
+        folder->cCFData = 1;
+        folder->typeCompress = tcompTYPE_MSZIP;
+        file->cbFile = sizeof(expected) - 1;
+        strcpy(name, "file.dat");
+        data->cbData = tests[i].size;
+        data->cbUncomp = sizeof(expected) - 1;
+        memcpy(data + 1, tests[i].data, tests[i].size);
+
+        mszip_cab.base = (const char *)cab;
+        mszip_cab.size = header->cbCabinet;
+        mszip_cab.pos = 0;
+        mszip_output_size = 0;
+
+        hfdi = FDICreate(fdi_alloc, fdi_free, fdi_mszip_open, fdi_mem_read,
+                         fdi_mszip_write, fdi_mem_close, fdi_mem_seek, cpuUNKNOWN, &erf);
+        ok(hfdi != NULL, "%u: FDICreate error %d\n", i, erf.erfOper);
+
+        memset(&erf, 0, sizeof(erf));
+        ret = FDICopy(hfdi, block, memory, 0, fdi_mszip_notify, NULL, 0);
+        if (tests[i].valid)
+        {
+            ok(ret, "%u: FDICopy error %d\n", i, erf.erfOper);
+            ok(mszip_output_size == sizeof(expected) - 1, "%u: got size %u\n", i, mszip_output_size);
+            ok(!memcmp(mszip_output, expected, sizeof(expected) - 1), "%u: got %s\n",
+               i, wine_dbgstr_an(mszip_output, mszip_output_size));
+        }
+        else
+        {
+            ok(!ret, "%u: FDICopy succeeded\n", i);
+            ok(erf.erfOper == FDIERROR_CORRUPT_CABINET, "%u: got error %d\n", i, erf.erfOper);
+        }
+
+        FDIDestroy(hfdi);
+    }
+}
+
+struct round_trip_file
+{
+    const char *name;
+    BYTE *data;
+    DWORD size;
+    BYTE *extracted;
+    DWORD extracted_size;
+};
+
+static struct round_trip_file round_trip_files[] =
+{
+    { "round1.dat", NULL, 300000 },
+    { "round2.dat", NULL, 100000 },
+};
+
+static UINT CDECL fdi_round_trip_write(INT_PTR hf, void *pv, UINT cb)
+{
+    struct round_trip_file *file = (struct round_trip_file *)hf;
+
+    if (file->extracted_size + cb > file->size) return -1;
+    memcpy(file->extracted + file->extracted_size, pv, cb);
+    file->extracted_size += cb;
+    return cb;
+}
+
+static INT_PTR CDECL fdi_round_trip_notify(FDINOTIFICATIONTYPE fdint, FDINOTIFICATION *info)
+{
+    unsigned int i;
+
+    switch (fdint)
+    {
+    case fdintCOPY_FILE:
+        for (i = 0; i < ARRAY_SIZE(round_trip_files); i++)
+        {
+            if (strcmp(info->psz1, round_trip_files[i].name)) continue;
+            ok(info->cb == round_trip_files[i].size, "%s: got size %d\n", info->psz1, info->cb);
+            round_trip_files[i].extracted_size = 0;
+            return (INT_PTR)&round_trip_files[i];
+        }
+        ok(0, "unexpected file %s\n", info->psz1);
+        return 0;
+
+    case fdintCLOSE_FILE_INFO:
+        return 1;
+
+    default:
+        return 0;
+    }
+}
+
+static void test_FCI_round_trip(DWORD threads)
+{
+    char name[] = "extract.cab", path[MAX_PATH];
+    DWORD written, disposition = 0, seed = 0xdeadbeef;
+    DWORD old_type, old_size = 0;
+    BYTE old_value[MAX_PATH];
+    unsigned int i, j;
+    HKEY hkey = NULL;
+    LONG res = 0;
+    CCAB cabParams;
+    HANDLE file;
+    HFDI hfdi;
+    HFCI hfci;
+    ERF erf;
+    BOOL ret;
+
+    /* the parallel compression path of the builtin cabinet is controlled by
+     * this setting, native ignores it; keep the user's value around */
+    if (!RegCreateKeyExA(HKEY_CURRENT_USER, "Software\\Wine\\Cabinet", 0, NULL, 0,
+                         KEY_ALL_ACCESS, NULL, &hkey, &disposition))
+    {
+        old_size = sizeof(old_value);
+        res = RegQueryValueExA(hkey, "CompressThreads", NULL, &old_type, old_value, &old_size);
+        if (res == ERROR_MORE_DATA)
+        {
+            skip("CompressThreads value is too large to be restored\n");
+            RegCloseKey(hkey);
+            return;
+        }
+        RegSetValueExA(hkey, "CompressThreads", 0, REG_DWORD, (const BYTE *)&threads, sizeof(threads));
+    }
+
+    /* the first file is larger than 8 full data blocks, and the second one is
+     * stored in another folder */
+    for (i = 0; i < ARRAY_SIZE(round_trip_files); i++)
+    {
+        round_trip_files[i].data = HeapAlloc(GetProcessHeap(), 0, round_trip_files[i].size);
+        round_trip_files[i].extracted = HeapAlloc(GetProcessHeap(), 0, round_trip_files[i].size);
+        for (j = 0; j < round_trip_files[i].size; j++)
+        {
+            seed = seed * 1103515245 + 12345;
+            round_trip_files[i].data[j] = 'a' + ((seed >> 16) % 16);
+        }
+        file = CreateFileA(round_trip_files[i].name, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, 0, NULL);
+        ok(file != INVALID_HANDLE_VALUE, "failed to create %s\n", round_trip_files[i].name);
+        WriteFile(file, round_trip_files[i].data, round_trip_files[i].size, &written, NULL);
+        CloseHandle(file);
+    }
+
+    set_cab_parameters(&cabParams);
+    hfci = FCICreate(&erf, file_placed, mem_alloc, mem_free, fci_open,
+                     fci_read, fci_write, fci_close, fci_seek,
+                     fci_delete, get_temp_file, &cabParams, NULL);
+    ok(hfci != NULL, "Failed to create an FCI context\n");
+
+    add_file(hfci, (char *)round_trip_files[0].name);
+    ret = FCIFlushFolder(hfci, get_next_cabinet, progress);
+    ok(ret, "Failed to flush the folder\n");
+    add_file(hfci, (char *)round_trip_files[1].name);
+
+    ret = FCIFlushCabinet(hfci, FALSE, get_next_cabinet, progress);
+    ok(ret, "Failed to flush the cabinet\n");
+    FCIDestroy(hfci);
+
+    lstrcpyA(path, CURR_DIR);
+    lstrcatA(path, "\\");
+
+    hfdi = FDICreate(fdi_alloc, fdi_free, fdi_open, fdi_read,
+                     fdi_round_trip_write, fdi_close, fdi_seek,
+                     cpuUNKNOWN, &erf);
+    ok(hfdi != NULL, "FDICreate error %d\n", erf.erfOper);
+
+    ret = FDICopy(hfdi, name, path, 0, fdi_round_trip_notify, NULL, 0);
+    ok(ret, "FDICopy error %d\n", erf.erfOper);
+    FDIDestroy(hfdi);
+
+    for (i = 0; i < ARRAY_SIZE(round_trip_files); i++)
+    {
+        ok(round_trip_files[i].extracted_size == round_trip_files[i].size, "%u: %s: got size %u\n",
+           threads, round_trip_files[i].name, round_trip_files[i].extracted_size);
+        ok(!memcmp(round_trip_files[i].extracted, round_trip_files[i].data, round_trip_files[i].size),
+           "%u: %s: extracted data doesn't match\n", threads, round_trip_files[i].name);
+        HeapFree(GetProcessHeap(), 0, round_trip_files[i].data);
+        HeapFree(GetProcessHeap(), 0, round_trip_files[i].extracted);
+        DeleteFileA(round_trip_files[i].name);
+    }
+    DeleteFileA(name);
+
+    if (hkey)
+    {
+        if (!res) RegSetValueExA(hkey, "CompressThreads", 0, old_type, old_value, old_size);
+        else RegDeleteValueA(hkey, "CompressThreads");
+        RegCloseKey(hkey);
+        if (disposition == REG_CREATED_NEW_KEY) RegDeleteKeyA(HKEY_CURRENT_USER, "Software\\Wine\\Cabinet");
+    }
+}
+
 
 START_TEST(fdi)
 {
@@ -948,4 +1218,7 @@ START_TEST(fdi)
     test_FDIDestroy();
     test_FDIIsCabinet();
     test_FDICopy();
+    test_FDICopy_mszip();
+    test_FCI_round_trip(1);
+    test_FCI_round_trip(4);
 }
@@ -24,6 +24,7 @@
 #define CERT_REVOCATION_PARA_HAS_EXTRA_FIELDS
 #include "wincrypt.h"
 #include "wininet.h"
+#include "snmp.h"
 #include "wine/debug.h"
 #include "wine/unicode.h"
 #include "crypt32_private.h"
@@ -252,10 +253,165 @@ void WINAPI CertFreeCertificateChainEngine(HCERTCHAINENGINE hChainEngine)
     free_chain_engine(get_chain_engine(hChainEngine, FALSE));
 }
 
+/* Successful signature checks are remembered, keyed on the encoded subject
+ * and issuer certificates, since building chains to the same roots verifies
+ * the same signatures over and over.  The key doesn't cover properties, so
+ * issuers whose public key takes its parameters from elsewhere (a DSA key
+ * with inherited parameters) are never cached.
+ */
+#define MAX_CACHED_SIGNATURES 64
+
+struct cached_signature
+{
+    struct list entry;
+    DWORD       hash;
+    DWORD       cbSubject;
+    DWORD       cbIssuer;
+    BYTE       *data;
+};
+
+static struct list signature_cache = LIST_INIT(signature_cache);
+static DWORD signature_cache_count;
+
+static CRITICAL_SECTION signature_cache_cs;
+static CRITICAL_SECTION_DEBUG signature_cache_cs_debug =
+{
+    0, 0, &signature_cache_cs,
+    { &signature_cache_cs_debug.ProcessLocksList,
+    &signature_cache_cs_debug.ProcessLocksList },
+    0, 0, { (DWORD_PTR)(__FILE__ ": signature_cache_cs") }
+};
+static CRITICAL_SECTION signature_cache_cs = { &signature_cache_cs_debug, -1, 0, 0, 0, 0 };
+
+static DWORD hash_cert_pair(PCCERT_CONTEXT subject, PCCERT_CONTEXT issuer)
+{
+    DWORD hash = 2166136261u, i;
+
+    for (i = 0; i < subject->cbCertEncoded; i++)
+        hash = (hash ^ subject->pbCertEncoded[i]) * 16777619u;
+    for (i = 0; i < issuer->cbCertEncoded; i++)
+        hash = (hash ^ issuer->pbCertEncoded[i]) * 16777619u;
+    return hash;
+}
+
+static struct cached_signature *find_cached_signature(DWORD hash,
+ PCCERT_CONTEXT subject, PCCERT_CONTEXT issuer)
+{
+    struct cached_signature *sig;
+
+    LIST_FOR_EACH_ENTRY(sig, &signature_cache, struct cached_signature, entry)
+    {
+        if (sig->hash == hash &&
+         sig->cbSubject == subject->cbCertEncoded &&
+         sig->cbIssuer == issuer->cbCertEncoded &&
+         !memcmp(sig->data, subject->pbCertEncoded, sig->cbSubject) &&
+         !memcmp(sig->data + sig->cbSubject, issuer->pbCertEncoded,
+         sig->cbIssuer))
+            return sig;
+    }
+    return NULL;
+}
+
+static void free_cached_signature(struct cached_signature *sig)
+{
+    list_remove(&sig->entry);
+    CryptMemFree(sig->data);
+    CryptMemFree(sig);
+}
+
+/* Returns whether the issuer's public key may depend on algorithm parameters
+ * that aren't part of its encoded certificate. */
+static BOOL has_inherited_key_params(PCCERT_CONTEXT issuer)
+{
+    static const BYTE nullParams[] = { ASN_NULL, 0 };
+    const CRYPT_ALGORITHM_IDENTIFIER *alg =
+     &issuer->pCertInfo->SubjectPublicKeyInfo.Algorithm;
+    DWORD size;
+
+    if (CertGetCertificateContextProperty(issuer, CERT_PUBKEY_ALG_PARA_PROP_ID,
+     NULL, &size))
+        return TRUE;
+    /* RSA keys have no parameters */
+    if (!strcmp(alg->pszObjId, szOID_RSA_RSA))
+        return FALSE;
+    return !alg->Parameters.cbData ||
+     (alg->Parameters.cbData == sizeof(nullParams) &&
+     !memcmp(alg->Parameters.pbData, nullParams, sizeof(nullParams)));
+}
+
+static BOOL CRYPT_VerifyCertSignature(DWORD dwCertEncodingType,
+ PCCERT_CONTEXT subject, PCCERT_CONTEXT issuer)
+{
+    struct cached_signature *sig;
+    DWORD hash;
+
+    if (has_inherited_key_params(issuer))
+        return CryptVerifyCertificateSignatureEx(0, dwCertEncodingType,
+         CRYPT_VERIFY_CERT_SIGN_SUBJECT_CERT, (void *)subject,
+         CRYPT_VERIFY_CERT_SIGN_ISSUER_CERT, (void *)issuer, 0, NULL);
+
+    hash = hash_cert_pair(subject, issuer);
+
+    EnterCriticalSection(&signature_cache_cs);
+    if ((sig = find_cached_signature(hash, subject, issuer)))
+    {
+        list_remove(&sig->entry);
+        list_add_head(&signature_cache, &sig->entry);
+    }
+    LeaveCriticalSection(&signature_cache_cs);
+    if (sig)
+        return TRUE;
+
+    if (!CryptVerifyCertificateSignatureEx(0, dwCertEncodingType,
+     CRYPT_VERIFY_CERT_SIGN_SUBJECT_CERT, (void *)subject,
+     CRYPT_VERIFY_CERT_SIGN_ISSUER_CERT, (void *)issuer, 0, NULL))
+        return FALSE;
+
+    if (!(sig = CryptMemAlloc(sizeof(*sig))))
+        return TRUE;
+    sig->hash = hash;
+    sig->cbSubject = subject->cbCertEncoded;
+    sig->cbIssuer = issuer->cbCertEncoded;
+    if (!(sig->data = CryptMemAlloc(sig->cbSubject + sig->cbIssuer)))
+    {
+        CryptMemFree(sig);
+        return TRUE;
+    }
+    memcpy(sig->data, subject->pbCertEncoded, sig->cbSubject);
+    memcpy(sig->data + sig->cbSubject, issuer->pbCertEncoded, sig->cbIssuer);
+
+    EnterCriticalSection(&signature_cache_cs);
+    if (find_cached_signature(hash, subject, issuer))
+    {
+        /* Another thread got here first */
+        CryptMemFree(sig->data);
+        CryptMemFree(sig);
+    }
+    else
+    {
+        list_add_head(&signature_cache, &sig->entry);
+        if (++signature_cache_count > MAX_CACHED_SIGNATURES)
+        {
+            free_cached_signature(LIST_ENTRY(list_tail(&signature_cache),
+             struct cached_signature, entry));
+            signature_cache_count--;
+        }
+    }
+    LeaveCriticalSection(&signature_cache_cs);
+    return TRUE;
+}
+
 void default_chain_engine_free(void)
 {
+    struct cached_signature *sig, *next;
+
     free_chain_engine(default_cu_engine);
     free_chain_engine(default_lm_engine);
+
+    LIST_FOR_EACH_ENTRY_SAFE(sig, next, &signature_cache,
+     struct cached_signature, entry)
+        free_cached_signature(sig);
+    signature_cache_count = 0;
 }
 
 typedef struct _CertificateChain
@@ -493,9 +649,7 @@ static void CRYPT_CheckRootCert(HCERTSTORE hRoot,
 {
     PCCERT_CONTEXT root = rootElement->pCertContext;
 
-    if (!CryptVerifyCertificateSignatureEx(0, root->dwCertEncodingType,
-     CRYPT_VERIFY_CERT_SIGN_SUBJECT_CERT, (void *)root,
-     CRYPT_VERIFY_CERT_SIGN_ISSUER_CERT, (void *)root, 0, NULL))
+    if (!CRYPT_VerifyCertSignature(root->dwCertEncodingType, root, root))
     {
         TRACE_(chain)("Last certificate's signature is invalid\n");
         rootElement->TrustStatus.dwErrorStatus |=
@@ -1913,11 +2067,9 @@ static void CRYPT_CheckSimpleChain(CertificateChainEngine *engine,
         if (i != 0)
         {
             /* Check the signature of the cert this issued */
-            if (!CryptVerifyCertificateSignatureEx(0, X509_ASN_ENCODING,
-             CRYPT_VERIFY_CERT_SIGN_SUBJECT_CERT,
-             (void *)chain->rgpElement[i - 1]->pCertContext,
-             CRYPT_VERIFY_CERT_SIGN_ISSUER_CERT,
-             (void *)chain->rgpElement[i]->pCertContext, 0, NULL))
+            if (!CRYPT_VerifyCertSignature(X509_ASN_ENCODING,
+             chain->rgpElement[i - 1]->pCertContext,
+             chain->rgpElement[i]->pCertContext))
                 chain->rgpElement[i - 1]->TrustStatus.dwErrorStatus |=
                  CERT_TRUST_IS_NOT_SIGNATURE_VALID;
             /* Once a path length constraint has been violated, every remaining
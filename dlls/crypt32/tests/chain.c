@@ -3875,6 +3875,42 @@ static ChainCheck chainCheckEmbeddedNullBroken = {
  0 };
 
 #define test_name_blob(a,b) _test_name_blob(__LINE__,a,b)
+static void compareChainStatus(PCCERT_CHAIN_CONTEXT chain,
+ PCCERT_CHAIN_CONTEXT again, DWORD testIndex)
+{
+    DWORD i, j;
+
+    ok(chain->TrustStatus.dwErrorStatus == again->TrustStatus.dwErrorStatus,
+     "Chain %d: error status %08x, then %08x\n", testIndex,
+     chain->TrustStatus.dwErrorStatus, again->TrustStatus.dwErrorStatus);
+    ok(chain->TrustStatus.dwInfoStatus == again->TrustStatus.dwInfoStatus,
+     "Chain %d: info status %08x, then %08x\n", testIndex,
+     chain->TrustStatus.dwInfoStatus, again->TrustStatus.dwInfoStatus);
+    ok(chain->cChain == again->cChain, "Chain %d: %d simple chains, then %d\n",
+     testIndex, chain->cChain, again->cChain);
+    for (i = 0; i < chain->cChain && i < again->cChain; i++)
+    {
+        const CERT_SIMPLE_CHAIN *simple = chain->rgpChain[i];
+        const CERT_SIMPLE_CHAIN *simpleAgain = again->rgpChain[i];
+
+        ok(simple->cElement == simpleAgain->cElement,
+         "Chain %d/%d: %d elements, then %d\n", testIndex, i,
+         simple->cElement, simpleAgain->cElement);
+        for (j = 0; j < simple->cElement && j < simpleAgain->cElement; j++)
+        {
+            const CERT_TRUST_STATUS *status = &simple->rgpElement[j]->TrustStatus;
+            const CERT_TRUST_STATUS *statusAgain =
+             &simpleAgain->rgpElement[j]->TrustStatus;
+
+            ok(status->dwErrorStatus == statusAgain->dwErrorStatus &&
+             status->dwInfoStatus == statusAgain->dwInfoStatus,
+             "Chain %d/%d/%d: status %08x/%08x, then %08x/%08x\n", testIndex, i,
+             j, status->dwErrorStatus, status->dwInfoStatus,
+             statusAgain->dwErrorStatus, statusAgain->dwInfoStatus);
+        }
+    }
+}
+
 static void _test_name_blob(unsigned line, CERT_NAME_BLOB *blob, const char *exdata)
 {
     char buf[1024];
@@ -4028,6 +4064,23 @@ static void testGetCertChain(void)
             pCertFreeCertificateChain(chain);
         }
     }
+    /* Building a chain again, with the signature checks already done once,
+     * must give the same result. */
+    for (i = 0; i < ARRAY_SIZE(chainCheck); i++)
+    {
+        PCCERT_CHAIN_CONTEXT again;
+
+        chain = getChain(NULL, &chainCheck[i].certs, 0, TRUE, chainCheck[i].validfor,
+         chainCheck[i].todo, i);
+        again = getChain(NULL, &chainCheck[i].certs, 0, TRUE, chainCheck[i].validfor,
+         chainCheck[i].todo, i);
+        if (chain && again)
+            compareChainStatus(chain, again, i);
+        if (chain)
+            pCertFreeCertificateChain(chain);
+        if (again)
+            pCertFreeCertificateChain(again);
+    }
     chain = getChain(NULL, &opensslChainCheck.certs, 0, TRUE, &oct2007,
      opensslChainCheck.todo, 0);
     if (chain)
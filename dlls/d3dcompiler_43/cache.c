@@ -0,0 +1,258 @@
+/*
+ * On-disk cache of compiled HLSL shaders
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#include <stdio.h>
+
+#include "d3dcompiler_private.h"
+#include "winreg.h"
+
+WINE_DEFAULT_DEBUG_CHANNEL(d3dcompiler);
+
+#define SHADER_CACHE_MAGIC   0x48435344 /* DSCH */
+#define SHADER_CACHE_VERSION 1
+
+/* Cache entries are looked up by a hash of the key, but the complete key is
+ * stored in the entry and compared on load. The key covers the preprocessed
+ * source, so defines and included files are accounted for. */
+struct shader_cache_header
+{
+    DWORD magic;
+    DWORD version;
+    DWORD key_size;
+    DWORD shader_size;
+    DWORD messages_size;
+};
+
+struct shader_cache_key_header
+{
+    FILETIME module_time;
+    DWORD compiler_version;
+    UINT sflags;
+    UINT eflags;
+};
+
+static INIT_ONCE shader_cache_init_once = INIT_ONCE_STATIC_INIT;
+static WCHAR shader_cache_path[MAX_PATH];
+static FILETIME shader_cache_module_time;
+
+static BOOL WINAPI shader_cache_init(INIT_ONCE *once, void *param, void **context)
+{
+    WIN32_FILE_ATTRIBUTE_DATA attr;
+    WCHAR module_path[MAX_PATH];
+    DWORD size, type;
+    HMODULE module;
+    HKEY key;
+
+    if (RegOpenKeyExW(HKEY_CURRENT_USER, L"Software\\Wine\\D3DCompiler", 0, KEY_READ, &key))
+        return TRUE;
+    size = sizeof(shader_cache_path) - sizeof(WCHAR);
+    if (RegQueryValueExW(key, L"ShaderCachePath", NULL, &type, (BYTE *)shader_cache_path, &size)
+            || type != REG_SZ)
+        shader_cache_path[0] = 0;
+    RegCloseKey(key);
+
+    if (!shader_cache_path[0])
+        return TRUE;
+
+    /* Entries written by a different build of the compiler are not reused. */
+    if (!GetModuleHandleExW(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS | GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT,
+            (const WCHAR *)shader_cache_init, &module)
+            || !GetModuleFileNameW(module, module_path, ARRAY_SIZE(module_path))
+            || !GetFileAttributesExW(module_path, GetFileExInfoStandard, &attr))
+    {
+        WARN("Failed to get the compiler module timestamp, disabling the shader cache.\n");
+        shader_cache_path[0] = 0;
+        return TRUE;
+    }
+    shader_cache_module_time = attr.ftLastWriteTime;
+
+    CreateDirectoryW(shader_cache_path, NULL);
+    TRACE("Using shader cache directory %s.\n", debugstr_w(shader_cache_path));
+    return TRUE;
+}
+
+static ULONG64 shader_cache_hash(const BYTE *data, SIZE_T size)
+{
+    ULONG64 hash = 0xcbf29ce484222325;
+    SIZE_T i;
+
+    for (i = 0; i < size; ++i)
+    {
+        hash ^= data[i];
+        hash *= 0x100000001b3;
+    }
+    return hash;
+}
+
+BOOL shader_cache_init_key(struct shader_cache_key *key, const char *source, SIZE_T source_size,
+        const char *target, const char *entrypoint, UINT sflags, UINT eflags)
+{
+    struct shader_cache_key_header header;
+    SIZE_T target_size, entrypoint_size;
+    BYTE *ptr;
+
+    InitOnceExecuteOnce(&shader_cache_init_once, shader_cache_init, NULL, NULL);
+    if (!shader_cache_path[0] || !target || !entrypoint)
+        return FALSE;
+
+    target_size = strlen(target) + 1;
+    entrypoint_size = strlen(entrypoint) + 1;
+    key->size = sizeof(header) + target_size + entrypoint_size + source_size;
+    if (key->size > ~0u || !(key->data = heap_alloc(key->size)))
+        return FALSE;
+
+    memset(&header, 0, sizeof(header));
+    header.module_time = shader_cache_module_time;
+    header.compiler_version = D3D_COMPILER_VERSION;
+    header.sflags = sflags;
+    header.eflags = eflags;
+
+    ptr = key->data;
+    memcpy(ptr, &header, sizeof(header));
+    ptr += sizeof(header);
+    memcpy(ptr, target, target_size);
+    ptr += target_size;
+    memcpy(ptr, entrypoint, entrypoint_size);
+    ptr += entrypoint_size;
+    memcpy(ptr, source, source_size);
+
+    key->hash = shader_cache_hash(key->data, key->size);
+    return TRUE;
+}
+
+void shader_cache_free_key(struct shader_cache_key *key)
+{
+    heap_free(key->data);
+}
+
+static void shader_cache_get_entry_path(const struct shader_cache_key *key, WCHAR *path, SIZE_T size)
+{
+    swprintf(path, size, L"%s\\%08x%08x", shader_cache_path,
+            (DWORD)(key->hash >> 32), (DWORD)key->hash);
+}
+
+static BOOL read_file_blob(HANDLE file, DWORD size, ID3DBlob **blob)
+{
+    DWORD read;
+
+    if (FAILED(D3DCreateBlob(size, blob)))
+        return FALSE;
+    if (!ReadFile(file, ID3D10Blob_GetBufferPointer(*blob), size, &read, NULL) || read != size)
+    {
+        ID3D10Blob_Release(*blob);
+        *blob = NULL;
+        return FALSE;
+    }
+    return TRUE;
+}
+
+BOOL shader_cache_load(const struct shader_cache_key *key, ID3DBlob **shader, ID3DBlob **messages)
+{
+    struct shader_cache_header header;
+    WCHAR path[MAX_PATH + 20];
+    LARGE_INTEGER file_size;
+    BYTE *stored_key = NULL;
+    BOOL ret = FALSE;
+    HANDLE file;
+    DWORD read;
+
+    *shader = *messages = NULL;
+
+    shader_cache_get_entry_path(key, path, ARRAY_SIZE(path));
+    file = CreateFileW(path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, NULL,
+            OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+        return FALSE;
+
+    if (!GetFileSizeEx(file, &file_size)
+            || !ReadFile(file, &header, sizeof(header), &read, NULL) || read != sizeof(header)
+            || header.magic != SHADER_CACHE_MAGIC || header.version != SHADER_CACHE_VERSION
+            || header.key_size != key->size || !header.shader_size
+            || (ULONG64)file_size.QuadPart != sizeof(header) + (ULONG64)header.key_size
+                    + header.shader_size + header.messages_size)
+        goto done;
+
+    if (!(stored_key = heap_alloc(header.key_size))
+            || !ReadFile(file, stored_key, header.key_size, &read, NULL) || read != header.key_size
+            || memcmp(stored_key, key->data, key->size))
+        goto done;
+
+    if (!read_file_blob(file, header.shader_size, shader))
+        goto done;
+    if (header.messages_size && !read_file_blob(file, header.messages_size, messages))
+    {
+        ID3D10Blob_Release(*shader);
+        *shader = NULL;
+        goto done;
+    }
+
+    TRACE("Loaded shader from cache entry %s.\n", debugstr_w(path));
+    ret = TRUE;
+
+done:
+    heap_free(stored_key);
+    CloseHandle(file);
+    return ret;
+}
+
+static BOOL write_file_data(HANDLE file, const void *data, DWORD size)
+{
+    DWORD written;
+
+    return !size || (WriteFile(file, data, size, &written, NULL) && written == size);
+}
+
+void shader_cache_save(const struct shader_cache_key *key, ID3DBlob *shader, ID3DBlob *messages)
+{
+    WCHAR path[MAX_PATH + 20], tmp_path[MAX_PATH + 40];
+    struct shader_cache_header header;
+    HANDLE file;
+    BOOL ret;
+
+    header.magic = SHADER_CACHE_MAGIC;
+    header.version = SHADER_CACHE_VERSION;
+    header.key_size = key->size;
+    header.shader_size = ID3D10Blob_GetBufferSize(shader);
+    header.messages_size = messages ? ID3D10Blob_GetBufferSize(messages) : 0;
+
+    /* Write to a private file first, so that concurrent readers never see a
+     * partially written entry. */
+    shader_cache_get_entry_path(key, path, ARRAY_SIZE(path));
+    swprintf(tmp_path, ARRAY_SIZE(tmp_path), L"%s.%x.%x.tmp", path,
+            GetCurrentProcessId(), GetCurrentThreadId());
+    file = CreateFileW(tmp_path, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        WARN("Failed to create cache file %s, error %u.\n", debugstr_w(tmp_path), GetLastError());
+        return;
+    }
+
+    ret = write_file_data(file, &header, sizeof(header))
+            && write_file_data(file, key->data, key->size)
+            && write_file_data(file, ID3D10Blob_GetBufferPointer(shader), header.shader_size)
+            && (!messages || write_file_data(file, ID3D10Blob_GetBufferPointer(messages), header.messages_size));
+    CloseHandle(file);
+
+    if (!ret || !MoveFileExW(tmp_path, path, MOVEFILE_REPLACE_EXISTING))
+    {
+        WARN("Failed to write cache entry %s, error %u.\n", debugstr_w(path), GetLastError());
+        DeleteFileW(tmp_path);
+        return;
+    }
+    TRACE("Stored shader in cache entry %s.\n", debugstr_w(path));
+}
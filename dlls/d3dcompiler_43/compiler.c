@@ -82,6 +82,19 @@ static CRITICAL_SECTION_DEBUG wpp_mutex_debug =
 };
 static CRITICAL_SECTION wpp_mutex = { &wpp_mutex_debug, -1, 0, 0, 0, 0 };
 
+/* The HLSL parser keeps its state in globals as well. It is independent from
+   wpp, so it has its own mutex and a shader can be compiled while another one
+   is being preprocessed. */
+static CRITICAL_SECTION hlsl_mutex;
+static CRITICAL_SECTION_DEBUG hlsl_mutex_debug =
+{
+    0, 0, &hlsl_mutex,
+    { &hlsl_mutex_debug.ProcessLocksList,
+      &hlsl_mutex_debug.ProcessLocksList },
+      0, 0, { (DWORD_PTR)(__FILE__ ": hlsl_mutex") }
+};
+static CRITICAL_SECTION hlsl_mutex = { &hlsl_mutex_debug, -1, 0, 0, 0, 0 };
+
 /* Preprocessor error reporting functions */
 static void wpp_write_message(const char *fmt, __ms_va_list args)
 {
@@ -854,12 +867,54 @@ static HRESULT compile_shader(const char *preproc_shader, const char *target, co
     return S_OK;
 }
 
+/* Appends compiler_messages to *messages. The reference to
+ * compiler_messages is consumed. */
+static HRESULT merge_messages(ID3DBlob **messages, ID3DBlob *compiler_messages)
+{
+    const char *first, *second;
+    SIZE_T first_len, second_len;
+    ID3DBlob *buffer;
+    HRESULT hr;
+    char *pos;
+
+    if (!compiler_messages)
+        return S_OK;
+    if (!*messages)
+    {
+        *messages = compiler_messages;
+        return S_OK;
+    }
+
+    first = ID3D10Blob_GetBufferPointer(*messages);
+    second = ID3D10Blob_GetBufferPointer(compiler_messages);
+    first_len = strnlen(first, ID3D10Blob_GetBufferSize(*messages));
+    second_len = strnlen(second, ID3D10Blob_GetBufferSize(compiler_messages));
+
+    hr = D3DCreateBlob(first_len + second_len + 1, &buffer);
+    if (SUCCEEDED(hr))
+    {
+        pos = ID3D10Blob_GetBufferPointer(buffer);
+        memcpy(pos, first, first_len);
+        memcpy(pos + first_len, second, second_len);
+        pos[first_len + second_len] = 0;
+        ID3D10Blob_Release(*messages);
+        *messages = buffer;
+    }
+    ID3D10Blob_Release(compiler_messages);
+    return hr;
+}
+
 HRESULT WINAPI D3DCompile2(const void *data, SIZE_T data_size, const char *filename,
         const D3D_SHADER_MACRO *defines, ID3DInclude *include, const char *entrypoint,
         const char *target, UINT sflags, UINT eflags, UINT secondary_flags,
         const void *secondary_data, SIZE_T secondary_data_size, ID3DBlob **shader,
         ID3DBlob **error_messages)
 {
+    ID3DBlob *code = NULL, *messages = NULL, *preproc_messages = NULL;
+    struct shader_cache_key cache_key;
+    char *preproc_shader;
+    int preproc_size;
+    BOOL use_cache;
     HRESULT hr;
 
     TRACE("data %p, data_size %lu, filename %s, defines %p, include %p, entrypoint %s, "
@@ -876,13 +931,59 @@ HRESULT WINAPI D3DCompile2(const void *data, SIZE_T data_size, const char *filen
     if (error_messages) *error_messages = NULL;
 
     EnterCriticalSection(&wpp_mutex);
+    hr = preprocess_shader(data, data_size, filename, defines, include,
+            error_messages ? &preproc_messages : NULL);
+    preproc_shader = wpp_output;
+    preproc_size = wpp_output_size;
+    wpp_output = NULL;
+    LeaveCriticalSection(&wpp_mutex);
 
-    hr = preprocess_shader(data, data_size, filename, defines, include, error_messages);
-    if (SUCCEEDED(hr))
-        hr = compile_shader(wpp_output, target, entrypoint, shader, error_messages);
+    if (FAILED(hr))
+    {
+        HeapFree(GetProcessHeap(), 0, preproc_shader);
+        if (error_messages)
+            *error_messages = preproc_messages;
+        return hr;
+    }
 
-    HeapFree(GetProcessHeap(), 0, wpp_output);
-    LeaveCriticalSection(&wpp_mutex);
+    use_cache = !secondary_data && shader_cache_init_key(&cache_key, preproc_shader, preproc_size,
+            target, entrypoint, sflags, eflags);
+    if (!use_cache || !shader_cache_load(&cache_key, &code, &messages))
+    {
+        EnterCriticalSection(&hlsl_mutex);
+        hr = compile_shader(preproc_shader, target, entrypoint, &code, &messages);
+        LeaveCriticalSection(&hlsl_mutex);
+
+        if (use_cache && SUCCEEDED(hr))
+            shader_cache_save(&cache_key, code, messages);
+    }
+    if (use_cache)
+        shader_cache_free_key(&cache_key);
+    HeapFree(GetProcessHeap(), 0, preproc_shader);
+
+    /* Only the compiler messages are cached; the preprocessor messages
+     * depend on more than the preprocessed source, so they always come from
+     * this call. */
+    if (error_messages)
+    {
+        HRESULT merge_hr = merge_messages(&preproc_messages, messages);
+
+        if (FAILED(merge_hr) && SUCCEEDED(hr))
+            hr = merge_hr;
+        *error_messages = preproc_messages;
+    }
+    else if (messages)
+        ID3D10Blob_Release(messages);
+
+    if (FAILED(hr) && code)
+    {
+        ID3D10Blob_Release(code);
+        code = NULL;
+    }
+    if (shader)
+        *shader = code;
+    else if (code)
+        ID3D10Blob_Release(code);
     return hr;
 }
 
@@ -1228,4 +1228,17 @@ static inline void write_dword(char **ptr, DWORD d)
 
 void skip_dword_unknown(const char **ptr, unsigned int count) DECLSPEC_HIDDEN;
 
+struct shader_cache_key
+{
+    BYTE *data;
+    SIZE_T size;
+    ULONG64 hash;
+};
+
+BOOL shader_cache_init_key(struct shader_cache_key *key, const char *source, SIZE_T source_size,
+        const char *target, const char *entrypoint, UINT sflags, UINT eflags) DECLSPEC_HIDDEN;
+void shader_cache_free_key(struct shader_cache_key *key) DECLSPEC_HIDDEN;
+BOOL shader_cache_load(const struct shader_cache_key *key, ID3DBlob **shader, ID3DBlob **messages) DECLSPEC_HIDDEN;
+void shader_cache_save(const struct shader_cache_key *key, ID3DBlob *shader, ID3DBlob *messages) DECLSPEC_HIDDEN;
+
 #endif /* __WINE_D3DCOMPILER_PRIVATE_H */
@@ -626,6 +626,143 @@ static void test_fail(IDirect3DDevice9 *device, IDirect3DVertexBuffer9 *qquad_ge
     }
 }
 
+static void clear_cache_entries(const char *dir, BOOL corrupt)
+{
+    static const char garbage[] = "not a shader cache entry";
+    char path[MAX_PATH];
+    WIN32_FIND_DATAA data;
+    HANDLE find, file;
+    DWORD written;
+
+    sprintf(path, "%s\\*", dir);
+    find = FindFirstFileA(path, &data);
+    if (find == INVALID_HANDLE_VALUE)
+        return;
+    do
+    {
+        if (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+            continue;
+        sprintf(path, "%s\\%s", dir, data.cFileName);
+        if (!corrupt)
+        {
+            DeleteFileA(path);
+            continue;
+        }
+        file = CreateFileA(path, GENERIC_WRITE, 0, NULL, OPEN_EXISTING, 0, NULL);
+        ok(file != INVALID_HANDLE_VALUE, "Failed to open %s, error %u.\n", path, GetLastError());
+        WriteFile(file, garbage, sizeof(garbage), &written, NULL);
+        CloseHandle(file);
+    } while (FindNextFileA(find, &data));
+    FindClose(find);
+}
+
+static void check_blobs_equal_(unsigned int line, ID3DBlob *blob, ID3DBlob *expected, const char *name)
+{
+    ok_(__FILE__, line)(!blob == !expected, "Got %s blob %p, expected %p.\n", name, blob, expected);
+    if (!blob || !expected)
+        return;
+    ok_(__FILE__, line)(ID3D10Blob_GetBufferSize(blob) == ID3D10Blob_GetBufferSize(expected),
+            "Got %s size %lu, expected %lu.\n", name, ID3D10Blob_GetBufferSize(blob),
+            ID3D10Blob_GetBufferSize(expected));
+    if (ID3D10Blob_GetBufferSize(blob) == ID3D10Blob_GetBufferSize(expected))
+        ok_(__FILE__, line)(!memcmp(ID3D10Blob_GetBufferPointer(blob), ID3D10Blob_GetBufferPointer(expected),
+                ID3D10Blob_GetBufferSize(blob)), "Got unexpected %s contents.\n", name);
+}
+#define check_blobs_equal(a, b, c) check_blobs_equal_(__LINE__, a, b, c)
+
+static void test_cache_child(const char *dir)
+{
+    /* The truncation of "a" gives a warning with the native compiler. */
+    static const char shader[] =
+        "float4 test(float4 pos : TEXCOORD0) : COLOR\n"
+        "{\n"
+        "    float2 a = pos;\n"
+        "    return a.xyxy;\n"
+        "}";
+    ID3DBlob *code[3], *errors[3];
+    HRESULT hr[3];
+    unsigned int i;
+
+    /* The first call populates the cache, the second one should be served
+     * from it, and the third one has to recompile after the entry has been
+     * corrupted. All three must give the same results. */
+    for (i = 0; i < ARRAY_SIZE(code); ++i)
+    {
+        if (i == 2)
+            clear_cache_entries(dir, TRUE);
+        code[i] = errors[i] = NULL;
+        hr[i] = ppD3DCompile(shader, strlen(shader), "cache.hlsl", NULL, NULL, "test", "ps_2_0",
+                0, 0, &code[i], &errors[i]);
+        ok(hr[i] == hr[0], "Compilation %u: got hr %#x, expected %#x.\n", i, hr[i], hr[0]);
+        check_blobs_equal(code[i], code[0], "shader");
+        check_blobs_equal(errors[i], errors[0], "messages");
+    }
+
+    for (i = 0; i < ARRAY_SIZE(code); ++i)
+    {
+        if (code[i]) ID3D10Blob_Release(code[i]);
+        if (errors[i]) ID3D10Blob_Release(errors[i]);
+    }
+}
+
+static void test_cache(void)
+{
+    char dir[MAX_PATH], cmdline[MAX_PATH * 2], old_path[MAX_PATH], **argv;
+    PROCESS_INFORMATION pi;
+    STARTUPINFOA si = {0};
+    DWORD old_size, old_type;
+    HKEY key;
+    LONG ret, res;
+
+    /* The cache is a Wine extension; native simply ignores the setting. It is
+     * read once per process, so the actual test runs in a child process. */
+    GetTempPathA(ARRAY_SIZE(dir), dir);
+    GetTempFileNameA(dir, "hls", 0, dir);
+    DeleteFileA(dir);
+    ok(CreateDirectoryA(dir, NULL), "Failed to create %s, error %u.\n", dir, GetLastError());
+
+    ret = RegCreateKeyExA(HKEY_CURRENT_USER, "Software\\Wine\\D3DCompiler", 0, NULL, 0,
+            KEY_QUERY_VALUE | KEY_SET_VALUE, NULL, &key, NULL);
+    if (ret)
+    {
+        skip("Failed to create the D3DCompiler key, error %d.\n", ret);
+        RemoveDirectoryA(dir);
+        return;
+    }
+    old_size = sizeof(old_path);
+    res = RegQueryValueExA(key, "ShaderCachePath", NULL, &old_type, (BYTE *)old_path, &old_size);
+    if (res == ERROR_MORE_DATA)
+    {
+        skip("ShaderCachePath value is too large to be restored.\n");
+        RegCloseKey(key);
+        RemoveDirectoryA(dir);
+        return;
+    }
+    ret = RegSetValueExA(key, "ShaderCachePath", 0, REG_SZ, (BYTE *)dir, strlen(dir) + 1);
+    ok(!ret, "Failed to set the cache path, error %d.\n", ret);
+
+    winetest_get_mainargs(&argv);
+    sprintf(cmdline, "\"%s\" hlsl cache \"%s\"", argv[0], dir);
+    si.cb = sizeof(si);
+    ret = CreateProcessA(NULL, cmdline, NULL, NULL, FALSE, 0, NULL, NULL, &si, &pi);
+    ok(ret, "Failed to create process, error %u.\n", GetLastError());
+    if (ret)
+    {
+        winetest_wait_child_process(pi.hProcess);
+        CloseHandle(pi.hProcess);
+        CloseHandle(pi.hThread);
+    }
+
+    if (!res)
+        RegSetValueExA(key, "ShaderCachePath", 0, old_type, (BYTE *)old_path, old_size);
+    else
+        RegDeleteValueA(key, "ShaderCachePath");
+    RegCloseKey(key);
+
+    clear_cache_entries(dir, FALSE);
+    ok(RemoveDirectoryA(dir), "Failed to remove %s, error %u.\n", dir, GetLastError());
+}
+
 static BOOL load_d3dcompiler(void)
 {
     HMODULE module;
@@ -649,6 +786,8 @@ START_TEST(hlsl)
     IDirect3DVertexBuffer9 *quad_geometry;
     IDirect3DVertexShader9 *vshader_passthru;
     HMODULE mod;
+    char **argv;
+    int argc;
 
     if (!load_d3dcompiler())
     {
@@ -656,6 +795,14 @@ START_TEST(hlsl)
         return;
     }
 
+    argc = winetest_get_mainargs(&argv);
+    if (argc >= 4 && !strcmp(argv[2], "cache"))
+    {
+        test_cache_child(argv[3]);
+        return;
+    }
+    test_cache();
+
     if (!(mod = LoadLibraryA("d3dx9_36.dll")))
     {
         win_skip("Failed to load d3dx9_36.dll.\n");
@@ -110,6 +110,11 @@ void point_filter_argb_pixels(const BYTE *src, UINT src_row_pitch, UINT src_slic
     const struct volume *src_size, const struct pixel_format_desc *src_format,
     BYTE *dst, UINT dst_row_pitch, UINT dst_slice_pitch, const struct volume *dst_size,
     const struct pixel_format_desc *dst_format, D3DCOLOR color_key, const PALETTEENTRY *palette) DECLSPEC_HIDDEN;
+void linear_filter_argb_pixels(const BYTE *src, UINT src_row_pitch, UINT src_slice_pitch,
+    const struct volume *src_size, const struct pixel_format_desc *src_format,
+    BYTE *dst, UINT dst_row_pitch, UINT dst_slice_pitch, const struct volume *dst_size,
+    const struct pixel_format_desc *dst_format, D3DCOLOR color_key, const PALETTEENTRY *palette,
+    DWORD filter) DECLSPEC_HIDDEN;
 
 HRESULT load_texture_from_dds(IDirect3DTexture9 *texture, const void *src_data, const PALETTEENTRY *palette,
         DWORD filter, D3DCOLOR color_key, const D3DXIMAGE_INFO *src_info, unsigned int skip_levels,
@@ -269,6 +274,7 @@ struct d3dx_regstore
 };
 
 struct d3dx_pres_ins;
+struct d3dx_pres_fast_ins;
 
 struct d3dx_preshader
 {
@@ -276,6 +282,7 @@ struct d3dx_preshader
 
     unsigned int ins_count;
     struct d3dx_pres_ins *ins;
+    struct d3dx_pres_fast_ins *fast_ins;
 
     struct d3dx_const_tab inputs;
 };
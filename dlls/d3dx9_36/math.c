@@ -392,16 +392,19 @@ D3DXMATRIX * WINAPI D3DXMatrixLookAtRH(D3DXMATRIX *out, const D3DXVECTOR3 *eye,
 
 D3DXMATRIX* WINAPI D3DXMatrixMultiply(D3DXMATRIX *pout, const D3DXMATRIX *pm1, const D3DXMATRIX *pm2)
 {
+    const D3DXMATRIX a = *pm1, b = *pm2;
     D3DXMATRIX out;
     int i,j;
 
     TRACE("pout %p, pm1 %p, pm2 %p\n", pout, pm1, pm2);
 
+    /* Each output row is a linear combination of the rows of pm2; with local
+     * copies the compiler can keep the rows in vector registers. */
     for (i=0; i<4; i++)
     {
         for (j=0; j<4; j++)
         {
-            out.u.m[i][j] = pm1->u.m[i][0] * pm2->u.m[0][j] + pm1->u.m[i][1] * pm2->u.m[1][j] + pm1->u.m[i][2] * pm2->u.m[2][j] + pm1->u.m[i][3] * pm2->u.m[3][j];
+            out.u.m[i][j] = a.u.m[i][0] * b.u.m[0][j] + a.u.m[i][1] * b.u.m[1][j] + a.u.m[i][2] * b.u.m[2][j] + a.u.m[i][3] * b.u.m[3][j];
         }
     }
 
@@ -1859,31 +1862,63 @@ D3DXVECTOR3* WINAPI D3DXVec3ProjectArray(D3DXVECTOR3* out, UINT outstride, const
     return out;
 }
 
+/* The array variants below copy the matrix once and use these helpers
+ * directly, instead of going through the traced single vector functions,
+ * so that the per element work stays in registers. */
+static inline void vec3_transform(D3DXVECTOR4 *out, const D3DXVECTOR3 *in, const D3DXMATRIX *m)
+{
+    const D3DXVECTOR3 v = *in;
+
+    out->x = m->u.m[0][0] * v.x + m->u.m[1][0] * v.y + m->u.m[2][0] * v.z + m->u.m[3][0];
+    out->y = m->u.m[0][1] * v.x + m->u.m[1][1] * v.y + m->u.m[2][1] * v.z + m->u.m[3][1];
+    out->z = m->u.m[0][2] * v.x + m->u.m[1][2] * v.y + m->u.m[2][2] * v.z + m->u.m[3][2];
+    out->w = m->u.m[0][3] * v.x + m->u.m[1][3] * v.y + m->u.m[2][3] * v.z + m->u.m[3][3];
+}
+
+static inline void vec3_transform_coord(D3DXVECTOR3 *out, const D3DXVECTOR3 *in, const D3DXMATRIX *m)
+{
+    const D3DXVECTOR3 v = *in;
+    FLOAT norm;
+
+    norm = m->u.m[0][3] * v.x + m->u.m[1][3] * v.y + m->u.m[2][3] * v.z + m->u.m[3][3];
+
+    out->x = (m->u.m[0][0] * v.x + m->u.m[1][0] * v.y + m->u.m[2][0] * v.z + m->u.m[3][0]) / norm;
+    out->y = (m->u.m[0][1] * v.x + m->u.m[1][1] * v.y + m->u.m[2][1] * v.z + m->u.m[3][1]) / norm;
+    out->z = (m->u.m[0][2] * v.x + m->u.m[1][2] * v.y + m->u.m[2][2] * v.z + m->u.m[3][2]) / norm;
+}
+
+static inline void vec3_transform_normal(D3DXVECTOR3 *out, const D3DXVECTOR3 *in, const D3DXMATRIX *m)
+{
+    const D3DXVECTOR3 v = *in;
+
+    out->x = m->u.m[0][0] * v.x + m->u.m[1][0] * v.y + m->u.m[2][0] * v.z;
+    out->y = m->u.m[0][1] * v.x + m->u.m[1][1] * v.y + m->u.m[2][1] * v.z;
+    out->z = m->u.m[0][2] * v.x + m->u.m[1][2] * v.y + m->u.m[2][2] * v.z;
+}
+
 D3DXVECTOR4* WINAPI D3DXVec3Transform(D3DXVECTOR4 *pout, const D3DXVECTOR3 *pv, const D3DXMATRIX *pm)
 {
     D3DXVECTOR4 out;
 
     TRACE("pout %p, pv %p, pm %p\n", pout, pv, pm);
 
-    out.x = pm->u.m[0][0] * pv->x + pm->u.m[1][0] * pv->y + pm->u.m[2][0] * pv->z + pm->u.m[3][0];
-    out.y = pm->u.m[0][1] * pv->x + pm->u.m[1][1] * pv->y + pm->u.m[2][1] * pv->z + pm->u.m[3][1];
-    out.z = pm->u.m[0][2] * pv->x + pm->u.m[1][2] * pv->y + pm->u.m[2][2] * pv->z + pm->u.m[3][2];
-    out.w = pm->u.m[0][3] * pv->x + pm->u.m[1][3] * pv->y + pm->u.m[2][3] * pv->z + pm->u.m[3][3];
+    vec3_transform(&out, pv, pm);
     *pout = out;
     return pout;
 }
 
 D3DXVECTOR4* WINAPI D3DXVec3TransformArray(D3DXVECTOR4* out, UINT outstride, const D3DXVECTOR3* in, UINT instride, const D3DXMATRIX* matrix, UINT elements)
 {
+    const D3DXMATRIX m = *matrix;
     UINT i;
 
     TRACE("out %p, outstride %u, in %p, instride %u, matrix %p, elements %u\n", out, outstride, in, instride, matrix, elements);
 
     for (i = 0; i < elements; ++i) {
-        D3DXVec3Transform(
+        vec3_transform(
             (D3DXVECTOR4*)((char*)out + outstride * i),
             (const D3DXVECTOR3*)((const char*)in + instride * i),
-            matrix);
+            &m);
     }
     return out;
 }
@@ -1891,16 +1926,10 @@ D3DXVECTOR4* WINAPI D3DXVec3TransformArray(D3DXVECTOR4* out, UINT outstride, con
 D3DXVECTOR3* WINAPI D3DXVec3TransformCoord(D3DXVECTOR3 *pout, const D3DXVECTOR3 *pv, const D3DXMATRIX *pm)
 {
     D3DXVECTOR3 out;
-    FLOAT norm;
 
     TRACE("pout %p, pv %p, pm %p\n", pout, pv, pm);
 
-    norm = pm->u.m[0][3] * pv->x + pm->u.m[1][3] * pv->y + pm->u.m[2][3] *pv->z + pm->u.m[3][3];
-
-    out.x = (pm->u.m[0][0] * pv->x + pm->u.m[1][0] * pv->y + pm->u.m[2][0] * pv->z + pm->u.m[3][0]) / norm;
-    out.y = (pm->u.m[0][1] * pv->x + pm->u.m[1][1] * pv->y + pm->u.m[2][1] * pv->z + pm->u.m[3][1]) / norm;
-    out.z = (pm->u.m[0][2] * pv->x + pm->u.m[1][2] * pv->y + pm->u.m[2][2] * pv->z + pm->u.m[3][2]) / norm;
-
+    vec3_transform_coord(&out, pv, pm);
     *pout = out;
 
     return pout;
@@ -1908,43 +1937,41 @@ D3DXVECTOR3* WINAPI D3DXVec3TransformCoord(D3DXVECTOR3 *pout, const D3DXVECTOR3
 
 D3DXVECTOR3* WINAPI D3DXVec3TransformCoordArray(D3DXVECTOR3* out, UINT outstride, const D3DXVECTOR3* in, UINT instride, const D3DXMATRIX* matrix, UINT elements)
 {
+    const D3DXMATRIX m = *matrix;
     UINT i;
 
     TRACE("out %p, outstride %u, in %p, instride %u, matrix %p, elements %u\n", out, outstride, in, instride, matrix, elements);
 
     for (i = 0; i < elements; ++i) {
-        D3DXVec3TransformCoord(
+        vec3_transform_coord(
             (D3DXVECTOR3*)((char*)out + outstride * i),
             (const D3DXVECTOR3*)((const char*)in + instride * i),
-            matrix);
+            &m);
     }
     return out;
 }
 
 D3DXVECTOR3* WINAPI D3DXVec3TransformNormal(D3DXVECTOR3 *pout, const D3DXVECTOR3 *pv, const D3DXMATRIX *pm)
 {
-    const D3DXVECTOR3 v = *pv;
-
     TRACE("pout %p, pv %p, pm %p\n", pout, pv, pm);
 
-    pout->x = pm->u.m[0][0] * v.x + pm->u.m[1][0] * v.y + pm->u.m[2][0] * v.z;
-    pout->y = pm->u.m[0][1] * v.x + pm->u.m[1][1] * v.y + pm->u.m[2][1] * v.z;
-    pout->z = pm->u.m[0][2] * v.x + pm->u.m[1][2] * v.y + pm->u.m[2][2] * v.z;
+    vec3_transform_normal(pout, pv, pm);
     return pout;
 
 }
 
 D3DXVECTOR3* WINAPI D3DXVec3TransformNormalArray(D3DXVECTOR3* out, UINT outstride, const D3DXVECTOR3* in, UINT instride, const D3DXMATRIX* matrix, UINT elements)
 {
+    const D3DXMATRIX m = *matrix;
     UINT i;
 
     TRACE("out %p, outstride %u, in %p, instride %u, matrix %p, elements %u\n", out, outstride, in, instride, matrix, elements);
 
     for (i = 0; i < elements; ++i) {
-        D3DXVec3TransformNormal(
+        vec3_transform_normal(
             (D3DXVECTOR3*)((char*)out + outstride * i),
             (const D3DXVECTOR3*)((const char*)in + instride * i),
-            matrix);
+            &m);
     }
     return out;
 }
@@ -2066,31 +2093,39 @@ D3DXVECTOR4* WINAPI D3DXVec4Normalize(D3DXVECTOR4 *pout, const D3DXVECTOR4 *pv)
     return pout;
 }
 
+static inline void vec4_transform(D3DXVECTOR4 *out, const D3DXVECTOR4 *in, const D3DXMATRIX *m)
+{
+    const D3DXVECTOR4 v = *in;
+
+    out->x = m->u.m[0][0] * v.x + m->u.m[1][0] * v.y + m->u.m[2][0] * v.z + m->u.m[3][0] * v.w;
+    out->y = m->u.m[0][1] * v.x + m->u.m[1][1] * v.y + m->u.m[2][1] * v.z + m->u.m[3][1] * v.w;
+    out->z = m->u.m[0][2] * v.x + m->u.m[1][2] * v.y + m->u.m[2][2] * v.z + m->u.m[3][2] * v.w;
+    out->w = m->u.m[0][3] * v.x + m->u.m[1][3] * v.y + m->u.m[2][3] * v.z + m->u.m[3][3] * v.w;
+}
+
 D3DXVECTOR4* WINAPI D3DXVec4Transform(D3DXVECTOR4 *pout, const D3DXVECTOR4 *pv, const D3DXMATRIX *pm)
 {
     D3DXVECTOR4 out;
 
     TRACE("pout %p, pv %p, pm %p\n", pout, pv, pm);
 
-    out.x = pm->u.m[0][0] * pv->x + pm->u.m[1][0] * pv->y + pm->u.m[2][0] * pv->z + pm->u.m[3][0] * pv->w;
-    out.y = pm->u.m[0][1] * pv->x + pm->u.m[1][1] * pv->y + pm->u.m[2][1] * pv->z + pm->u.m[3][1] * pv->w;
-    out.z = pm->u.m[0][2] * pv->x + pm->u.m[1][2] * pv->y + pm->u.m[2][2] * pv->z + pm->u.m[3][2] * pv->w;
-    out.w = pm->u.m[0][3] * pv->x + pm->u.m[1][3] * pv->y + pm->u.m[2][3] * pv->z + pm->u.m[3][3] * pv->w;
+    vec4_transform(&out, pv, pm);
     *pout = out;
     return pout;
 }
 
 D3DXVECTOR4* WINAPI D3DXVec4TransformArray(D3DXVECTOR4* out, UINT outstride, const D3DXVECTOR4* in, UINT instride, const D3DXMATRIX* matrix, UINT elements)
 {
+    const D3DXMATRIX m = *matrix;
     UINT i;
 
     TRACE("out %p, outstride %u, in %p, instride %u, matrix %p, elements %u\n", out, outstride, in, instride, matrix, elements);
 
     for (i = 0; i < elements; ++i) {
-        D3DXVec4Transform(
+        vec4_transform(
             (D3DXVECTOR4*)((char*)out + outstride * i),
             (const D3DXVECTOR4*)((const char*)in + instride * i),
-            matrix);
+            &m);
     }
     return out;
 }
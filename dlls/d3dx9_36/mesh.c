@@ -1603,8 +1603,49 @@ static HRESULT remap_faces_for_attrsort(struct d3dx9_mesh *This, const DWORD *in
         DWORD *attrib_buffer, DWORD **sorted_attrib_buffer, DWORD **face_remap)
 {
     DWORD **sorted_attrib_ptr_buffer = NULL;
+    DWORD max_attrib = 0;
     DWORD i;
 
+    for (i = 0; i < This->numfaces; i++)
+        max_attrib = max(max_attrib, attrib_buffer[i]);
+
+    /* Attribute ids are usually small, in which case a counting sort is
+     * both stable and linear in the number of faces. */
+    if (max_attrib < This->numfaces)
+    {
+        DWORD *offsets, offset = 0, count;
+
+        if (!(offsets = HeapAlloc(GetProcessHeap(), HEAP_ZERO_MEMORY, (max_attrib + 1) * sizeof(*offsets))))
+            return E_OUTOFMEMORY;
+        *face_remap = HeapAlloc(GetProcessHeap(), 0, This->numfaces * sizeof(**face_remap));
+        *sorted_attrib_buffer = HeapAlloc(GetProcessHeap(), 0, This->numfaces * sizeof(**sorted_attrib_buffer));
+        if (!*face_remap || !*sorted_attrib_buffer)
+        {
+            HeapFree(GetProcessHeap(), 0, *sorted_attrib_buffer);
+            HeapFree(GetProcessHeap(), 0, *face_remap);
+            HeapFree(GetProcessHeap(), 0, offsets);
+            *sorted_attrib_buffer = *face_remap = NULL;
+            return E_OUTOFMEMORY;
+        }
+
+        for (i = 0; i < This->numfaces; i++)
+            offsets[attrib_buffer[i]]++;
+        for (i = 0; i <= max_attrib; i++)
+        {
+            count = offsets[i];
+            offsets[i] = offset;
+            offset += count;
+        }
+        for (i = 0; i < This->numfaces; i++)
+        {
+            (*face_remap)[i] = offsets[attrib_buffer[i]]++;
+            (*sorted_attrib_buffer)[(*face_remap)[i]] = attrib_buffer[i];
+        }
+
+        HeapFree(GetProcessHeap(), 0, offsets);
+        return D3D_OK;
+    }
+
     sorted_attrib_ptr_buffer = HeapAlloc(GetProcessHeap(), 0, This->numfaces * sizeof(*sorted_attrib_ptr_buffer));
     if (!sorted_attrib_ptr_buffer)
         return E_OUTOFMEMORY;
@@ -1634,6 +1675,276 @@ static HRESULT remap_faces_for_attrsort(struct d3dx9_mesh *This, const DWORD *in
     return D3D_OK;
 }
 
+/* Vertex cache optimization, following Tom Forsyth's "Linear-speed vertex
+ * cache optimisation". Faces are greedily emitted in the order that scores
+ * best against a simulated LRU post-transform cache. */
+#define VERTEX_CACHE_SIZE 32
+#define VERTEX_VALENCE_TABLE_SIZE 64
+
+struct vertex_cache_vertex
+{
+    float score;
+    int cache_pos;
+    DWORD valence; /* faces of the current attribute group not emitted yet */
+    /* Faces using the vertex are stored at vertex_faces[face_start]; the
+     * first face_count ones haven't been emitted yet. */
+    DWORD face_start, face_count;
+};
+
+static float vertex_cache_position_score[VERTEX_CACHE_SIZE];
+static float vertex_cache_valence_score[VERTEX_VALENCE_TABLE_SIZE];
+
+static BOOL WINAPI init_vertex_cache_scores(INIT_ONCE *once, void *param, void **context)
+{
+    unsigned int i;
+
+    /* The last face's vertices get a fixed score, so that the next face
+     * doesn't simply reuse two of them in a strip-like fashion. */
+    for (i = 0; i < 3; i++)
+        vertex_cache_position_score[i] = 0.75f;
+    for (; i < VERTEX_CACHE_SIZE; i++)
+        vertex_cache_position_score[i] = powf(1.0f - (i - 3) / (float)(VERTEX_CACHE_SIZE - 3), 1.5f);
+    /* Prefer vertices with few remaining faces, to avoid leaving lone faces behind. */
+    for (i = 1; i < VERTEX_VALENCE_TABLE_SIZE; i++)
+        vertex_cache_valence_score[i] = 2.0f / sqrtf(i);
+
+    return TRUE;
+}
+
+static float vertex_cache_score(const struct vertex_cache_vertex *vertex)
+{
+    float score;
+
+    if (!vertex->valence)
+        return -1.0f;
+
+    score = vertex->cache_pos < 0 ? 0.0f : vertex_cache_position_score[vertex->cache_pos];
+    if (vertex->valence < VERTEX_VALENCE_TABLE_SIZE)
+        return score + vertex_cache_valence_score[vertex->valence];
+    return score + 2.0f / sqrtf(vertex->valence);
+}
+
+/* Reorders the faces within each attribute group for the post-transform
+ * vertex cache. face_remap maps old faces to their attribute sorted
+ * position on input, and to their final position on output. */
+static HRESULT optimize_faces_for_vertex_cache(DWORD num_faces, DWORD num_vertices, const DWORD *indices,
+        const DWORD *sorted_attrib_buffer, DWORD *face_remap)
+{
+    static INIT_ONCE init_once = INIT_ONCE_STATIC_INIT;
+    struct vertex_cache_vertex *vertices;
+    DWORD *order, *vertex_faces, *new_order;
+    DWORD cache[VERTEX_CACHE_SIZE + 3];
+    DWORD group_start, group_end, next_face, emitted, cache_size, i, j, k;
+    BYTE *face_added;
+    HRESULT hr = E_OUTOFMEMORY;
+
+    InitOnceExecuteOnce(&init_once, init_vertex_cache_scores, NULL, NULL);
+
+    vertices = HeapAlloc(GetProcessHeap(), HEAP_ZERO_MEMORY, num_vertices * sizeof(*vertices));
+    order = HeapAlloc(GetProcessHeap(), 0, num_faces * sizeof(*order));
+    new_order = HeapAlloc(GetProcessHeap(), 0, num_faces * sizeof(*new_order));
+    vertex_faces = HeapAlloc(GetProcessHeap(), 0, num_faces * 3 * sizeof(*vertex_faces));
+    face_added = HeapAlloc(GetProcessHeap(), HEAP_ZERO_MEMORY, num_faces * sizeof(*face_added));
+    if (!vertices || !order || !new_order || !vertex_faces || !face_added)
+        goto cleanup;
+
+    /* Work on faces in attribute sorted order. */
+    for (i = 0; i < num_faces; i++)
+        order[face_remap[i]] = i;
+
+    for (i = 0; i < num_faces * 3; i++)
+        vertices[indices[i]].face_count++;
+    for (i = 0, k = 0; i < num_vertices; i++)
+    {
+        vertices[i].face_start = k;
+        vertices[i].cache_pos = -1;
+        k += vertices[i].face_count;
+        vertices[i].face_count = 0;
+    }
+    for (i = 0; i < num_faces; i++)
+    {
+        for (j = 0; j < 3; j++)
+        {
+            struct vertex_cache_vertex *vertex = &vertices[indices[order[i] * 3 + j]];
+            vertex_faces[vertex->face_start + vertex->face_count++] = i;
+        }
+    }
+
+    for (group_start = 0; group_start < num_faces; group_start = group_end)
+    {
+        DWORD best_face = ~0u;
+
+        for (group_end = group_start + 1; group_end < num_faces
+                && sorted_attrib_buffer[group_end] == sorted_attrib_buffer[group_start]; group_end++)
+            ;
+
+        for (i = group_start; i < group_end; i++)
+        {
+            for (j = 0; j < 3; j++)
+                vertices[indices[order[i] * 3 + j]].valence++;
+        }
+        for (i = group_start; i < group_end; i++)
+        {
+            for (j = 0; j < 3; j++)
+                vertices[indices[order[i] * 3 + j]].score = vertex_cache_score(&vertices[indices[order[i] * 3 + j]]);
+        }
+
+        cache_size = 0;
+        next_face = group_start;
+        for (emitted = group_start; emitted < group_end; emitted++)
+        {
+            DWORD new_cache[VERTEX_CACHE_SIZE + 3], new_cache_size = 0;
+            const DWORD *face;
+            float best_score;
+
+            if (best_face == ~0u)
+            {
+                /* Nothing in the cache is connected to a pending face,
+                 * continue with the next one in the original order. */
+                while (face_added[next_face])
+                    next_face++;
+                best_face = next_face;
+            }
+
+            new_order[emitted] = best_face;
+            face_added[best_face] = 1;
+            face = &indices[order[best_face] * 3];
+
+            for (j = 0; j < 3; j++)
+            {
+                struct vertex_cache_vertex *vertex = &vertices[face[j]];
+                DWORD *faces = &vertex_faces[vertex->face_start];
+
+                /* Move the face out of the pending part of the list. */
+                for (k = 0; faces[k] != best_face; k++)
+                    ;
+                faces[k] = faces[--vertex->face_count];
+
+                vertex->valence--;
+                new_cache[new_cache_size++] = face[j];
+            }
+            for (j = 0; j < cache_size; j++)
+            {
+                if (cache[j] != face[0] && cache[j] != face[1] && cache[j] != face[2])
+                    new_cache[new_cache_size++] = cache[j];
+            }
+
+            for (j = 0; j < new_cache_size; j++)
+            {
+                struct vertex_cache_vertex *vertex = &vertices[new_cache[j]];
+
+                vertex->cache_pos = j < VERTEX_CACHE_SIZE ? j : -1;
+                vertex->score = vertex_cache_score(vertex);
+            }
+
+            /* Rescore the pending faces using the cached vertices, and pick
+             * the best one as the next face. */
+            best_face = ~0u;
+            best_score = -1.0f;
+            for (j = 0; j < new_cache_size; j++)
+            {
+                const struct vertex_cache_vertex *vertex = &vertices[new_cache[j]];
+
+                for (k = 0; k < vertex->face_count; k++)
+                {
+                    DWORD f = vertex_faces[vertex->face_start + k];
+                    const DWORD *other;
+                    float score;
+
+                    if (f >= group_end)
+                        continue;
+                    other = &indices[order[f] * 3];
+                    score = vertices[other[0]].score + vertices[other[1]].score + vertices[other[2]].score;
+                    if (score > best_score)
+                    {
+                        best_score = score;
+                        best_face = f;
+                    }
+                }
+            }
+
+            cache_size = min(new_cache_size, VERTEX_CACHE_SIZE);
+            memcpy(cache, new_cache, cache_size * sizeof(*cache));
+        }
+
+        /* Each group starts with an empty cache. */
+        for (j = 0; j < cache_size; j++)
+            vertices[cache[j]].cache_pos = -1;
+    }
+
+    for (i = 0; i < num_faces; i++)
+        face_remap[order[new_order[i]]] = i;
+    hr = D3D_OK;
+
+cleanup:
+    HeapFree(GetProcessHeap(), 0, face_added);
+    HeapFree(GetProcessHeap(), 0, vertex_faces);
+    HeapFree(GetProcessHeap(), 0, new_order);
+    HeapFree(GetProcessHeap(), 0, order);
+    HeapFree(GetProcessHeap(), 0, vertices);
+    return hr;
+}
+
+/* Creates a vertex_remap that orders the vertices by their first use in the
+ * new face order. Unused vertices are moved to the end, or dropped if
+ * compact is set. Indices are updated according to the vertex_remap. */
+static HRESULT remap_vertices_for_face_order(struct d3dx9_mesh *This, DWORD *indices,
+        const DWORD *face_remap, BOOL compact, DWORD *new_num_vertices, ID3DXBuffer **vertex_remap)
+{
+    DWORD *vertex_remap_ptr, *old_to_new, *faces;
+    DWORD num_used_vertices = 0;
+    DWORD i, j;
+    HRESULT hr;
+
+    old_to_new = HeapAlloc(GetProcessHeap(), 0, This->numvertices * sizeof(*old_to_new));
+    faces = HeapAlloc(GetProcessHeap(), 0, This->numfaces * sizeof(*faces));
+    if (!old_to_new || !faces)
+    {
+        hr = E_OUTOFMEMORY;
+        goto cleanup;
+    }
+
+    hr = D3DXCreateBuffer(This->numvertices * sizeof(DWORD), vertex_remap);
+    if (FAILED(hr)) goto cleanup;
+    vertex_remap_ptr = ID3DXBuffer_GetBufferPointer(*vertex_remap);
+
+    for (i = 0; i < This->numfaces; i++)
+        faces[face_remap[i]] = i;
+    memset(old_to_new, 0xff, This->numvertices * sizeof(*old_to_new));
+    for (i = 0; i < This->numfaces; i++)
+    {
+        for (j = 0; j < 3; j++)
+        {
+            DWORD index = indices[faces[i] * 3 + j];
+
+            if (old_to_new[index] == -1)
+            {
+                vertex_remap_ptr[num_used_vertices] = index;
+                old_to_new[index] = num_used_vertices++;
+            }
+        }
+    }
+
+    *new_num_vertices = num_used_vertices;
+    for (i = 0; i < This->numvertices; i++)
+    {
+        if (old_to_new[i] != -1)
+            continue;
+        if (compact)
+            vertex_remap_ptr[num_used_vertices++] = -1;
+        else
+            vertex_remap_ptr[(*new_num_vertices)++] = i;
+    }
+
+    for (i = 0; i < This->numfaces * 3; i++)
+        indices[i] = old_to_new[indices[i]];
+
+cleanup:
+    HeapFree(GetProcessHeap(), 0, faces);
+    HeapFree(GetProcessHeap(), 0, old_to_new);
+    return hr;
+}
+
 static HRESULT WINAPI d3dx9_mesh_OptimizeInplace(ID3DXMesh *iface, DWORD flags, const DWORD *adjacency_in,
         DWORD *adjacency_out, DWORD *face_remap_out, ID3DXBuffer **vertex_remap_out)
 {
@@ -1660,14 +1971,14 @@ static HRESULT WINAPI d3dx9_mesh_OptimizeInplace(ID3DXMesh *iface, DWORD flags,
     if ((flags & (D3DXMESHOPT_VERTEXCACHE | D3DXMESHOPT_STRIPREORDER)) == (D3DXMESHOPT_VERTEXCACHE | D3DXMESHOPT_STRIPREORDER))
         return D3DERR_INVALIDCALL;
 
-    if (flags & (D3DXMESHOPT_VERTEXCACHE | D3DXMESHOPT_STRIPREORDER))
+    if (flags & D3DXMESHOPT_STRIPREORDER)
     {
-        if (flags & D3DXMESHOPT_VERTEXCACHE)
-            FIXME("D3DXMESHOPT_VERTEXCACHE not implemented.\n");
-        if (flags & D3DXMESHOPT_STRIPREORDER)
-            FIXME("D3DXMESHOPT_STRIPREORDER not implemented.\n");
+        FIXME("D3DXMESHOPT_STRIPREORDER not implemented.\n");
         return E_NOTIMPL;
     }
+    /* Faces are only reordered within attribute groups. */
+    if (flags & D3DXMESHOPT_VERTEXCACHE)
+        flags |= D3DXMESHOPT_ATTRSORT;
 
     hr = iface->lpVtbl->LockIndexBuffer(iface, 0, &indices);
     if (FAILED(hr)) goto cleanup;
@@ -1688,18 +1999,26 @@ static HRESULT WINAPI d3dx9_mesh_OptimizeInplace(ID3DXMesh *iface, DWORD flags,
         hr = compact_mesh(This, dword_indices, &new_num_vertices, &vertex_remap);
         if (FAILED(hr)) goto cleanup;
     } else if (flags & D3DXMESHOPT_ATTRSORT) {
-        if (!(flags & D3DXMESHOPT_IGNOREVERTS))
-        {
-            FIXME("D3DXMESHOPT_ATTRSORT vertex reordering not implemented.\n");
-            hr = E_NOTIMPL;
-            goto cleanup;
-        }
-
         hr = iface->lpVtbl->LockAttributeBuffer(iface, 0, &attrib_buffer);
         if (FAILED(hr)) goto cleanup;
 
         hr = remap_faces_for_attrsort(This, dword_indices, attrib_buffer, &sorted_attrib_buffer, &face_remap);
         if (FAILED(hr)) goto cleanup;
+
+        if (flags & D3DXMESHOPT_VERTEXCACHE)
+        {
+            hr = optimize_faces_for_vertex_cache(This->numfaces, This->numvertices, dword_indices,
+                    sorted_attrib_buffer, face_remap);
+            if (FAILED(hr)) goto cleanup;
+        }
+
+        if (!(flags & D3DXMESHOPT_IGNOREVERTS))
+        {
+            new_num_alloc_vertices = This->numvertices;
+            hr = remap_vertices_for_face_order(This, dword_indices, face_remap,
+                    flags & D3DXMESHOPT_COMPACT, &new_num_vertices, &vertex_remap);
+            if (FAILED(hr)) goto cleanup;
+        }
     }
 
     if (vertex_remap)
@@ -1792,9 +2111,10 @@ static HRESULT WINAPI d3dx9_mesh_OptimizeInplace(ID3DXMesh *iface, DWORD flags,
             for (i = 0; i < This->numfaces; i++) {
                 DWORD old_pos = i * 3;
                 DWORD new_pos = face_remap[i] * 3;
-                adjacency_out[new_pos++] = face_remap[adjacency_in[old_pos++]];
-                adjacency_out[new_pos++] = face_remap[adjacency_in[old_pos++]];
-                adjacency_out[new_pos++] = face_remap[adjacency_in[old_pos++]];
+                DWORD j;
+
+                for (j = 0; j < 3; j++, old_pos++, new_pos++)
+                    adjacency_out[new_pos] = adjacency_in[old_pos] == -1 ? -1 : face_remap[adjacency_in[old_pos]];
             }
         } else {
             memcpy(adjacency_out, adjacency_in, This->numfaces * 3 * sizeof(*adjacency_out));
@@ -257,6 +257,29 @@ struct d3dx_pres_ins
     struct d3dx_pres_operand output;
 };
 
+struct d3dx_pres_fast_arg
+{
+    const void *data;
+    BOOL is_double;
+    /* component 0 is replicated to all components */
+    BOOL scalar;
+};
+
+/* Instruction with register references resolved to table pointers once the
+ * register tables are allocated. Instructions which need relative addressing
+ * or have input and output registers overlapping in a way which makes the
+ * result depend on component evaluation order are run through the generic
+ * path instead. */
+struct d3dx_pres_fast_ins
+{
+    enum pres_ops op;
+    BOOL generic;
+    unsigned int component_count;
+    struct d3dx_pres_fast_arg inputs[MAX_INPUTS_COUNT];
+    void *output;
+    enum pres_value_type output_type;
+};
+
 struct const_upload_info
 {
     BOOL transpose;
@@ -1220,6 +1243,76 @@ static HRESULT parse_preshader(struct d3dx_preshader *pres, unsigned int *ptr, u
     return D3D_OK;
 }
 
+static BOOL pres_input_overlaps_output(const struct d3dx_pres_ins *ins, unsigned int input_idx)
+{
+    const struct d3dx_pres_reg *in = &ins->inputs[input_idx].reg;
+    const struct d3dx_pres_reg *out = &ins->output.reg;
+
+    if (in->table != out->table)
+        return FALSE;
+
+    /* The generic path reads the inputs and writes the output one component
+     * at a time, so a component written earlier may be read back by a later one. */
+    if (ins->scalar_op && !input_idx)
+        return in->offset >= out->offset && in->offset - out->offset + 1 < ins->component_count;
+    return in->offset < out->offset && out->offset - in->offset < ins->component_count;
+}
+
+static HRESULT compile_preshader(struct d3dx_preshader *pres)
+{
+    struct d3dx_regstore *rs = &pres->regs;
+    unsigned int i, j, generic_count = 0;
+
+    if (!pres->ins_count)
+        return D3D_OK;
+
+    if (pres->ins_count > UINT_MAX / sizeof(*pres->fast_ins))
+        return E_OUTOFMEMORY;
+    pres->fast_ins = HeapAlloc(GetProcessHeap(), HEAP_ZERO_MEMORY, sizeof(*pres->fast_ins) * pres->ins_count);
+    if (!pres->fast_ins)
+        return E_OUTOFMEMORY;
+
+    for (i = 0; i < pres->ins_count; ++i)
+    {
+        const struct d3dx_pres_ins *ins = &pres->ins[i];
+        struct d3dx_pres_fast_ins *fast = &pres->fast_ins[i];
+        const struct op_info *oi = &pres_op_info[ins->op];
+        unsigned int table;
+
+        fast->op = ins->op;
+        fast->component_count = ins->component_count;
+
+        for (j = 0; j < oi->input_count; ++j)
+        {
+            const struct d3dx_pres_operand *opr = &ins->inputs[j];
+
+            table = opr->reg.table;
+            if (opr->index_reg.table != PRES_REGTAB_COUNT
+                    || (table_info[table].type != PRES_VT_FLOAT && table_info[table].type != PRES_VT_DOUBLE)
+                    || (!oi->func_all_comps && pres_input_overlaps_output(ins, j)))
+            {
+                fast->generic = TRUE;
+                break;
+            }
+            fast->inputs[j].data = (BYTE *)rs->tables[table] + table_info[table].component_size * opr->reg.offset;
+            fast->inputs[j].is_double = table_info[table].type == PRES_VT_DOUBLE;
+            fast->inputs[j].scalar = ins->scalar_op && !j;
+        }
+        if (fast->generic)
+        {
+            ++generic_count;
+            continue;
+        }
+
+        table = ins->output.reg.table;
+        fast->output = (BYTE *)rs->tables[table] + table_info[table].component_size * ins->output.reg.offset;
+        fast->output_type = table_info[table].type;
+    }
+    TRACE("%u of %u instructions use the generic path.\n", generic_count, pres->ins_count);
+
+    return D3D_OK;
+}
+
 HRESULT d3dx_create_param_eval(struct d3dx_effect *effect, void *byte_code, unsigned int byte_code_size,
         D3DXPARAMETER_TYPE type, struct d3dx_param_eval **peval_out, ULONG64 *version_counter,
         const char **skip_constants, unsigned int skip_constants_count)
@@ -1306,6 +1399,9 @@ HRESULT d3dx_create_param_eval(struct d3dx_effect *effect, void *byte_code, unsi
             goto err_out;
     }
 
+    if (FAILED(ret = compile_preshader(&peval->pres)))
+        goto err_out;
+
     if (TRACE_ON(d3dx))
     {
         dump_bytecode(byte_code, byte_code_size);
@@ -1340,6 +1436,7 @@ static void d3dx_free_const_tab(struct d3dx_const_tab *ctab)
 static void d3dx_free_preshader(struct d3dx_preshader *pres)
 {
     HeapFree(GetProcessHeap(), 0, pres->ins);
+    HeapFree(GetProcessHeap(), 0, pres->fast_ins);
 
     regstore_free_tables(&pres->regs);
     d3dx_free_const_tab(&pres->inputs);
@@ -1645,6 +1742,120 @@ static void exec_set_arg(struct d3dx_regstore *rs, const struct d3dx_pres_reg *r
     regstore_set_double(rs, reg->table, reg->offset + comp, res);
 }
 
+static void execute_fast_ins(const struct d3dx_pres_fast_ins *ins)
+{
+    const struct op_info *oi = &pres_op_info[ins->op];
+    double src[MAX_INPUTS_COUNT][4], res[4];
+    unsigned int i, j, n, out_count;
+
+    n = ins->component_count;
+    for (i = 0; i < oi->input_count; ++i)
+    {
+        const struct d3dx_pres_fast_arg *arg = &ins->inputs[i];
+
+        if (arg->is_double)
+        {
+            const double *d = arg->data;
+
+            for (j = 0; j < n; ++j)
+                src[i][j] = d[arg->scalar ? 0 : j];
+        }
+        else
+        {
+            const float *f = arg->data;
+
+            for (j = 0; j < n; ++j)
+                src[i][j] = f[arg->scalar ? 0 : j];
+        }
+    }
+
+    out_count = n;
+    switch (ins->op)
+    {
+        case PRESHADER_OP_MOV:
+            for (j = 0; j < n; ++j)
+                res[j] = src[0][j];
+            break;
+        case PRESHADER_OP_NEG:
+            for (j = 0; j < n; ++j)
+                res[j] = -src[0][j];
+            break;
+        case PRESHADER_OP_RCP:
+            for (j = 0; j < n; ++j)
+                res[j] = 1.0 / src[0][j];
+            break;
+        case PRESHADER_OP_MIN:
+            for (j = 0; j < n; ++j)
+                res[j] = fmin(src[0][j], src[1][j]);
+            break;
+        case PRESHADER_OP_MAX:
+            for (j = 0; j < n; ++j)
+                res[j] = fmax(src[0][j], src[1][j]);
+            break;
+        case PRESHADER_OP_LT:
+            for (j = 0; j < n; ++j)
+                res[j] = src[0][j] < src[1][j] ? 1.0 : 0.0;
+            break;
+        case PRESHADER_OP_GE:
+            for (j = 0; j < n; ++j)
+                res[j] = src[0][j] >= src[1][j] ? 1.0 : 0.0;
+            break;
+        case PRESHADER_OP_ADD:
+            for (j = 0; j < n; ++j)
+                res[j] = src[0][j] + src[1][j];
+            break;
+        case PRESHADER_OP_MUL:
+            for (j = 0; j < n; ++j)
+                res[j] = src[0][j] * src[1][j];
+            break;
+        case PRESHADER_OP_CMP:
+            for (j = 0; j < n; ++j)
+                res[j] = src[0][j] >= 0.0 ? src[1][j] : src[2][j];
+            break;
+        case PRESHADER_OP_DOT:
+            res[0] = 0.0;
+            for (j = 0; j < n; ++j)
+                res[0] += src[0][j] * src[1][j];
+            out_count = 1;
+            break;
+        default:
+        {
+            double args[MAX_INPUTS_COUNT];
+
+            for (j = 0; j < n; ++j)
+            {
+                for (i = 0; i < oi->input_count; ++i)
+                    args[i] = src[i][j];
+                res[j] = oi->func(args, n);
+            }
+            break;
+        }
+    }
+
+    switch (ins->output_type)
+    {
+        case PRES_VT_FLOAT:
+            for (j = 0; j < out_count; ++j)
+                ((float *)ins->output)[j] = res[j];
+            break;
+        case PRES_VT_DOUBLE:
+            for (j = 0; j < out_count; ++j)
+                ((double *)ins->output)[j] = res[j];
+            break;
+        case PRES_VT_INT:
+            for (j = 0; j < out_count; ++j)
+                ((int *)ins->output)[j] = lrint(res[j]);
+            break;
+        case PRES_VT_BOOL:
+            for (j = 0; j < out_count; ++j)
+                ((BOOL *)ins->output)[j] = !!res[j];
+            break;
+        default:
+            FIXME("Bad type %u.\n", ins->output_type);
+            break;
+    }
+}
+
 #define ARGS_ARRAY_SIZE 8
 static HRESULT execute_preshader(struct d3dx_preshader *pres)
 {
@@ -1657,6 +1868,12 @@ static HRESULT execute_preshader(struct d3dx_preshader *pres)
         const struct d3dx_pres_ins *ins;
         const struct op_info *oi;
 
+        if (!pres->fast_ins[i].generic)
+        {
+            execute_fast_ins(&pres->fast_ins[i]);
+            continue;
+        }
+
         ins = &pres->ins[i];
         oi = &pres_op_info[ins->op];
         if (oi->func_all_comps)
@@ -1824,6 +1824,386 @@ void point_filter_argb_pixels(const BYTE *src, UINT src_row_pitch, UINT src_slic
     }
 }
 
+struct filter_taps
+{
+    unsigned int max_count;
+    unsigned int *count;
+    unsigned int *index;
+    float *weight;
+};
+
+static void free_filter_taps(struct filter_taps *taps)
+{
+    heap_free(taps->count);
+    heap_free(taps->index);
+    heap_free(taps->weight);
+}
+
+/* Computes, for each destination coordinate along one axis, the source
+ * coordinates contributing to it and their weights. */
+static BOOL init_filter_taps(struct filter_taps *taps, DWORD filter, unsigned int src_size, unsigned int dst_size)
+{
+    float scale = (float)src_size / dst_size;
+    unsigned int i, j;
+
+    if (filter == D3DX_FILTER_TRIANGLE && src_size <= dst_size)
+        filter = D3DX_FILTER_LINEAR;
+
+    if (filter == D3DX_FILTER_LINEAR)
+        taps->max_count = 2;
+    else
+        taps->max_count = (src_size + dst_size - 1) / dst_size + 1;
+
+    taps->count = heap_alloc(dst_size * sizeof(*taps->count));
+    taps->index = heap_alloc(dst_size * taps->max_count * sizeof(*taps->index));
+    taps->weight = heap_alloc(dst_size * taps->max_count * sizeof(*taps->weight));
+    if (!taps->count || !taps->index || !taps->weight)
+    {
+        free_filter_taps(taps);
+        return FALSE;
+    }
+
+    for (i = 0; i < dst_size; ++i)
+    {
+        unsigned int *index = &taps->index[i * taps->max_count];
+        float *weight = &taps->weight[i * taps->max_count];
+
+        if (filter == D3DX_FILTER_LINEAR)
+        {
+            float center = (i + 0.5f) * scale - 0.5f;
+            int first = floorf(center);
+            float frac = center - first;
+
+            index[0] = max(0, min(first, (int)src_size - 1));
+            index[1] = max(0, min(first + 1, (int)src_size - 1));
+            weight[0] = 1.0f - frac;
+            weight[1] = frac;
+            taps->count[i] = 2;
+        }
+        else if (filter == D3DX_FILTER_BOX)
+        {
+            unsigned int start = (UINT64)i * src_size / dst_size;
+            unsigned int end = (UINT64)(i + 1) * src_size / dst_size;
+
+            if (end <= start)
+                end = start + 1;
+            for (j = start; j < end; ++j)
+            {
+                index[j - start] = j;
+                weight[j - start] = 1.0f / (end - start);
+            }
+            taps->count[i] = end - start;
+        }
+        else
+        {
+            /* Triangle filter, downscaling: each source texel contributes
+             * by the fraction of it covered by the destination texel. */
+            float start = i * scale, end = (i + 1) * scale;
+            unsigned int count = 0;
+
+            for (j = floorf(start); j < src_size && j < end; ++j)
+            {
+                float w = (min(end, j + 1.0f) - max(start, (float)j)) / scale;
+
+                if (w <= 0.0f)
+                    continue;
+                index[count] = j;
+                weight[count++] = w;
+            }
+            taps->count[i] = count;
+        }
+    }
+
+    return TRUE;
+}
+
+static void get_filter_src_color(const BYTE *src, const struct pixel_format_desc *src_format,
+        const PALETTEENTRY *palette, const struct pixel_format_desc *ck_format, D3DCOLOR color_key,
+        struct vec4 *color)
+{
+    struct vec4 tmp;
+
+    format_to_vec4(src_format, src, &tmp);
+    if (src_format->to_rgba)
+        src_format->to_rgba(&tmp, color, palette);
+    else
+        *color = tmp;
+
+    if (ck_format)
+    {
+        DWORD ck_pixel;
+
+        format_from_vec4(ck_format, color, (BYTE *)&ck_pixel);
+        if (ck_pixel == color_key)
+            color->w = 0.0f;
+    }
+}
+
+static BOOL is_half_size(unsigned int src_size, unsigned int dst_size)
+{
+    return src_size == dst_size * 2 || (src_size == 1 && dst_size == 1);
+}
+
+/* Fast path for the common mipmap generation case: halving an image with
+ * four 8-bit channels, where all the filters reduce to averaging 2x2 texels. */
+static BOOL box_filter_8888_pixels(const BYTE *src, UINT src_row_pitch, UINT src_slice_pitch,
+        const struct volume *src_size, const struct pixel_format_desc *src_format,
+        BYTE *dst, UINT dst_row_pitch, UINT dst_slice_pitch, const struct volume *dst_size,
+        const struct pixel_format_desc *dst_format, D3DCOLOR color_key)
+{
+    unsigned int x, y, z, c;
+
+    if (src_format != dst_format || color_key || src_format->type != FORMAT_ARGB
+            || src_format->bytes_per_pixel != 4 || src_format->to_rgba)
+        return FALSE;
+    for (c = 0; c < 4; ++c)
+    {
+        if (src_format->bits[c] != 8)
+            return FALSE;
+    }
+    if (src_size->depth != dst_size->depth || !is_half_size(src_size->width, dst_size->width)
+            || !is_half_size(src_size->height, dst_size->height))
+        return FALSE;
+
+    for (z = 0; z < dst_size->depth; ++z)
+    {
+        for (y = 0; y < dst_size->height; ++y)
+        {
+            const BYTE *row0 = src + z * src_slice_pitch + y * 2 * src_row_pitch;
+            const BYTE *row1 = src_size->height > 1 ? row0 + src_row_pitch : row0;
+            unsigned int step = src_size->width > 1 ? 4 : 0;
+            BYTE *dst_ptr = dst + z * dst_slice_pitch + y * dst_row_pitch;
+
+            for (x = 0; x < dst_size->width * 4; x += 4)
+            {
+                const BYTE *p0 = row0 + x * 2, *p1 = row1 + x * 2;
+
+                for (c = 0; c < 4; ++c)
+                    dst_ptr[x + c] = (p0[c] + p0[c + step] + p1[c] + p1[c + step] + 2) >> 2;
+            }
+        }
+    }
+
+    return TRUE;
+}
+
+/************************************************************
+ * linear_filter_argb_pixels
+ *
+ * Copies the source buffer to the destination buffer, performing
+ * any necessary format conversion, color keying and stretching
+ * using a linear, triangle or box filter.
+ */
+void linear_filter_argb_pixels(const BYTE *src, UINT src_row_pitch, UINT src_slice_pitch, const struct volume *src_size,
+        const struct pixel_format_desc *src_format, BYTE *dst, UINT dst_row_pitch, UINT dst_slice_pitch,
+        const struct volume *dst_size, const struct pixel_format_desc *dst_format, D3DCOLOR color_key,
+        const PALETTEENTRY *palette, DWORD filter)
+{
+    const struct pixel_format_desc *ck_format = NULL;
+    struct filter_taps taps_x, taps_y, taps_z;
+    UINT x, y, z, i, j, k;
+
+    TRACE("src %p, src_row_pitch %u, src_slice_pitch %u, src_size %p, src_format %p, dst %p, "
+            "dst_row_pitch %u, dst_slice_pitch %u, dst_size %p, dst_format %p, color_key 0x%08x, palette %p, "
+            "filter %#x.\n", src, src_row_pitch, src_slice_pitch, src_size, src_format, dst, dst_row_pitch,
+            dst_slice_pitch, dst_size, dst_format, color_key, palette, filter);
+
+    filter &= 0xf;
+
+    if (box_filter_8888_pixels(src, src_row_pitch, src_slice_pitch, src_size, src_format,
+            dst, dst_row_pitch, dst_slice_pitch, dst_size, dst_format, color_key))
+        return;
+
+    if (!init_filter_taps(&taps_x, filter, src_size->width, dst_size->width))
+        goto fallback;
+    if (!init_filter_taps(&taps_y, filter, src_size->height, dst_size->height))
+    {
+        free_filter_taps(&taps_x);
+        goto fallback;
+    }
+    if (!init_filter_taps(&taps_z, filter, src_size->depth, dst_size->depth))
+    {
+        free_filter_taps(&taps_y);
+        free_filter_taps(&taps_x);
+        goto fallback;
+    }
+
+    if (color_key)
+    {
+        /* Color keys are always represented in D3DFMT_A8R8G8B8 format. */
+        ck_format = get_format_info(D3DFMT_A8R8G8B8);
+    }
+
+    for (z = 0; z < dst_size->depth; z++)
+    {
+        const unsigned int *index_z = &taps_z.index[z * taps_z.max_count];
+        const float *weight_z = &taps_z.weight[z * taps_z.max_count];
+        BYTE *dst_slice_ptr = dst + z * dst_slice_pitch;
+
+        for (y = 0; y < dst_size->height; y++)
+        {
+            const unsigned int *index_y = &taps_y.index[y * taps_y.max_count];
+            const float *weight_y = &taps_y.weight[y * taps_y.max_count];
+            BYTE *dst_ptr = dst_slice_ptr + y * dst_row_pitch;
+
+            for (x = 0; x < dst_size->width; x++)
+            {
+                const unsigned int *index_x = &taps_x.index[x * taps_x.max_count];
+                const float *weight_x = &taps_x.weight[x * taps_x.max_count];
+                struct vec4 color = {0.0f, 0.0f, 0.0f, 0.0f}, tmp;
+
+                for (k = 0; k < taps_z.count[z]; ++k)
+                {
+                    const BYTE *src_slice_ptr = src + index_z[k] * src_slice_pitch;
+
+                    for (j = 0; j < taps_y.count[y]; ++j)
+                    {
+                        const BYTE *src_row_ptr = src_slice_ptr + index_y[j] * src_row_pitch;
+                        float w = weight_z[k] * weight_y[j];
+
+                        for (i = 0; i < taps_x.count[x]; ++i)
+                        {
+                            get_filter_src_color(src_row_ptr + index_x[i] * src_format->bytes_per_pixel,
+                                    src_format, palette, ck_format, color_key, &tmp);
+                            color.x += tmp.x * w * weight_x[i];
+                            color.y += tmp.y * w * weight_x[i];
+                            color.z += tmp.z * w * weight_x[i];
+                            color.w += tmp.w * w * weight_x[i];
+                        }
+                    }
+                }
+
+                if (dst_format->from_rgba)
+                {
+                    dst_format->from_rgba(&color, &tmp);
+                    color = tmp;
+                }
+
+                format_from_vec4(dst_format, &color, dst_ptr);
+                dst_ptr += dst_format->bytes_per_pixel;
+            }
+        }
+    }
+
+    free_filter_taps(&taps_z);
+    free_filter_taps(&taps_y);
+    free_filter_taps(&taps_x);
+    return;
+
+fallback:
+    ERR("Failed to allocate filter taps, falling back to point filtering.\n");
+    point_filter_argb_pixels(src, src_row_pitch, src_slice_pitch, src_size, src_format,
+            dst, dst_row_pitch, dst_slice_pitch, dst_size, dst_format, color_key, palette);
+}
+
+/* Number of pixel rows compressed by a single DXTn compression work item. */
+#define DXTN_BAND_HEIGHT 32
+
+static INIT_ONCE dxtn_config_once = INIT_ONCE_STATIC_INIT;
+static GLboolean dxtn_fast_compression;
+
+static BOOL WINAPI init_dxtn_config(INIT_ONCE *once, void *param, void **context)
+{
+    char buffer[16] = {0};
+    DWORD size = sizeof(buffer) - 1;
+    HKEY hkey;
+
+    if (!RegOpenKeyA(HKEY_CURRENT_USER, "Software\\Wine\\Direct3D", &hkey))
+    {
+        if (!RegQueryValueExA(hkey, "DXTnCompressionQuality", NULL, NULL, (BYTE *)buffer, &size))
+        {
+            if (!strcmp(buffer, "fast"))
+                dxtn_fast_compression = GL_TRUE;
+            else if (strcmp(buffer, "high"))
+                WARN("Unknown DXTn compression quality %s.\n", debugstr_a(buffer));
+        }
+        RegCloseKey(hkey);
+    }
+
+    TRACE("Using %s DXTn compression.\n", dxtn_fast_compression ? "fast" : "high quality");
+    return TRUE;
+}
+
+struct dxtn_compress_context
+{
+    const BYTE *src;
+    BYTE *dst;
+    unsigned int width, height, dst_pitch;
+    GLenum format;
+    LONG next_band;
+    LONG band_count;
+    LONG pending;
+    HANDLE done_event;
+};
+
+static void compress_dxtn_bands(struct dxtn_compress_context *context)
+{
+    LONG band;
+
+    while ((band = InterlockedIncrement(&context->next_band) - 1) < context->band_count)
+    {
+        unsigned int y = band * DXTN_BAND_HEIGHT;
+
+        tx_compress_dxtn(4, context->width, min(DXTN_BAND_HEIGHT, context->height - y),
+                context->src + y * context->width * 4, context->format,
+                context->dst + y / 4 * context->dst_pitch, context->dst_pitch, dxtn_fast_compression);
+    }
+}
+
+static void CALLBACK compress_dxtn_callback(TP_CALLBACK_INSTANCE *instance, void *param)
+{
+    struct dxtn_compress_context *context = param;
+
+    compress_dxtn_bands(context);
+    if (!InterlockedDecrement(&context->pending))
+        SetEvent(context->done_event);
+}
+
+/* Compresses a 32-bit RGBA image to DXTn. The bands of block rows are
+ * independent, so large images are spread over the thread pool. */
+static void compress_dxtn(const BYTE *src, unsigned int width, unsigned int height, GLenum format,
+        BYTE *dst, unsigned int dst_pitch)
+{
+    struct dxtn_compress_context context;
+    unsigned int i, thread_count;
+    SYSTEM_INFO info;
+
+    InitOnceExecuteOnce(&dxtn_config_once, init_dxtn_config, NULL, NULL);
+
+    context.src = src;
+    context.dst = dst;
+    context.width = width;
+    context.height = height;
+    context.dst_pitch = dst_pitch;
+    context.format = format;
+    context.next_band = 0;
+    context.band_count = (height + DXTN_BAND_HEIGHT - 1) / DXTN_BAND_HEIGHT;
+    context.pending = 1;
+    context.done_event = NULL;
+
+    GetSystemInfo(&info);
+    thread_count = min(info.dwNumberOfProcessors, context.band_count);
+    if (thread_count > 1 && (context.done_event = CreateEventW(NULL, FALSE, FALSE, NULL)))
+    {
+        for (i = 1; i < thread_count; ++i)
+        {
+            InterlockedIncrement(&context.pending);
+            if (!TrySubmitThreadpoolCallback(compress_dxtn_callback, &context, NULL))
+            {
+                InterlockedDecrement(&context.pending);
+                break;
+            }
+        }
+    }
+
+    compress_dxtn_bands(&context);
+
+    if (InterlockedDecrement(&context.pending))
+        WaitForSingleObject(context.done_event, INFINITE);
+    if (context.done_event)
+        CloseHandle(context.done_event);
+}
+
 /************************************************************
  * D3DXLoadSurfaceFromMemory
  *
@@ -2060,13 +2440,17 @@ HRESULT WINAPI D3DXLoadSurfaceFromMemory(IDirect3DSurface9 *dst_surface,
             convert_argb_pixels(src_memory, src_pitch, 0, &src_size, srcformatdesc,
                     dst_mem, dst_pitch, 0, &dst_size, dst_format, color_key, src_palette);
         }
-        else /* if ((filter & 0xf) == D3DX_FILTER_POINT) */
+        else if ((filter & 0xf) == D3DX_FILTER_LINEAR || (filter & 0xf) == D3DX_FILTER_TRIANGLE
+                || (filter & 0xf) == D3DX_FILTER_BOX)
+        {
+            linear_filter_argb_pixels(src_memory, src_pitch, 0, &src_size, srcformatdesc,
+                    dst_mem, dst_pitch, 0, &dst_size, dst_format, color_key, src_palette, filter);
+        }
+        else
         {
             if ((filter & 0xf) != D3DX_FILTER_POINT)
                 FIXME("Unhandled filter %#x.\n", filter);
 
-            /* Always apply a point filter until D3DX_FILTER_LINEAR,
-             * D3DX_FILTER_TRIANGLE and D3DX_FILTER_BOX are implemented. */
             point_filter_argb_pixels(src_memory, src_pitch, 0, &src_size, srcformatdesc,
                     dst_mem, dst_pitch, 0, &dst_size, dst_format, color_key, src_palette);
         }
@@ -2094,9 +2478,8 @@ HRESULT WINAPI D3DXLoadSurfaceFromMemory(IDirect3DSurface9 *dst_surface,
                 default:
                     ERR("Unexpected destination compressed format %u.\n", surfdesc.Format);
             }
-            tx_compress_dxtn(4, dst_size_aligned.width, dst_size_aligned.height,
-                    dst_uncompressed, gl_format, lockrect.pBits,
-                    lockrect.Pitch * destformatdesc->block_width / destformatdesc->block_byte_count);
+            compress_dxtn(dst_uncompressed, dst_size_aligned.width, dst_size_aligned.height,
+                    gl_format, lockrect.pBits, lockrect.Pitch);
             heap_free(dst_uncompressed);
         }
     }
@@ -3181,6 +3181,11 @@ static void test_D3DXVec_Array(void)
     D3DXVec4TransformArray(&out_vec[1], sizeof(*out_vec), inp_vec, sizeof(*inp_vec), &mat, ARRAY_SIZE(inp_vec));
     expect_vec4_array(ARRAY_SIZE(exp_vec), exp_vec, out_vec, 0);
 
+    /* D3DXVec4TransformArray in place */
+    memcpy(&out_vec[1], inp_vec, sizeof(inp_vec));
+    D3DXVec4TransformArray(&out_vec[1], sizeof(*out_vec), &out_vec[1], sizeof(*out_vec), &mat, ARRAY_SIZE(inp_vec));
+    expect_vec4_array(ARRAY_SIZE(exp_vec), exp_vec, out_vec, 0);
+
     /* D3DXPlaneTransformArray */
     exp_plane[1].a = 90.0f; exp_plane[1].b = 100.0f; exp_plane[1].c = 110.0f; exp_plane[1].d = 120.0f;
     exp_plane[2].a = 82.0f; exp_plane[2].b = 92.0f;  exp_plane[2].c = 102.0f; exp_plane[2].d = 112.0f;
@@ -10626,6 +10626,289 @@ static HRESULT compute_normals_D3DXComputeTangentFrameEx(ID3DXMesh *mesh, const
             adjacency, -1.01f, -0.01f, -1.01f, NULL, NULL);
 }
 
+#define check_optimized_mesh(a, b, c, d, e, f, g, h, i, j) \
+        check_optimized_mesh_(__LINE__, a, b, c, d, e, f, g, h, i, j)
+static void check_optimized_mesh_(unsigned int line, ID3DXMesh *mesh, const D3DXVECTOR3 *orig_vertices,
+        const DWORD *orig_indices, const DWORD *orig_attribs, const DWORD *adjacency_in,
+        const DWORD *adjacency_out, const DWORD *face_remap, ID3DXBuffer *vertex_remap_buffer,
+        DWORD expected_num_vertices, DWORD orig_num_vertices)
+{
+    DWORD num_faces = mesh->lpVtbl->GetNumFaces(mesh);
+    DWORD num_vertices = mesh->lpVtbl->GetNumVertices(mesh);
+    BOOL is_32bit = !!(mesh->lpVtbl->GetOptions(mesh) & D3DXMESH_32BIT);
+    D3DXATTRIBUTERANGE attrib_table[8];
+    DWORD attrib_table_size, i, j;
+    const DWORD *vertex_remap;
+    DWORD *old_to_new;
+    D3DXVECTOR3 *vertices;
+    DWORD *attribs;
+    void *indices;
+    HRESULT hr;
+
+    ok_(__FILE__, line)(num_vertices == expected_num_vertices, "Got %u vertices, expected %u.\n",
+            num_vertices, expected_num_vertices);
+    ok_(__FILE__, line)(!!vertex_remap_buffer, "Got no vertex remap.\n");
+    if (!vertex_remap_buffer || num_vertices != expected_num_vertices)
+        return;
+    ok_(__FILE__, line)(ID3DXBuffer_GetBufferSize(vertex_remap_buffer) >= num_vertices * sizeof(DWORD),
+            "Got unexpected vertex remap size %u.\n", ID3DXBuffer_GetBufferSize(vertex_remap_buffer));
+    vertex_remap = ID3DXBuffer_GetBufferPointer(vertex_remap_buffer);
+
+    old_to_new = HeapAlloc(GetProcessHeap(), 0, num_faces * sizeof(*old_to_new));
+    memset(old_to_new, 0xff, num_faces * sizeof(*old_to_new));
+    for (i = 0; i < num_faces; i++)
+    {
+        ok_(__FILE__, line)(face_remap[i] < num_faces && old_to_new[face_remap[i]] == ~0u,
+                "Face remap %u is %u.\n", i, face_remap[i]);
+        if (face_remap[i] < num_faces)
+            old_to_new[face_remap[i]] = i;
+    }
+
+    hr = mesh->lpVtbl->LockVertexBuffer(mesh, D3DLOCK_READONLY, (void **)&vertices);
+    ok_(__FILE__, line)(hr == D3D_OK, "Got unexpected hr %#x.\n", hr);
+    for (i = 0; i < num_vertices; i++)
+    {
+        ok_(__FILE__, line)(vertex_remap[i] < orig_num_vertices, "Vertex remap %u is %#x.\n", i, vertex_remap[i]);
+        if (vertex_remap[i] < orig_num_vertices)
+            ok_(__FILE__, line)(compare_vec3(vertices[i], orig_vertices[vertex_remap[i]]),
+                    "Vertex %u doesn't match original vertex %u.\n", i, vertex_remap[i]);
+    }
+    mesh->lpVtbl->UnlockVertexBuffer(mesh);
+
+    hr = mesh->lpVtbl->LockAttributeBuffer(mesh, D3DLOCK_READONLY, &attribs);
+    ok_(__FILE__, line)(hr == D3D_OK, "Got unexpected hr %#x.\n", hr);
+    hr = mesh->lpVtbl->LockIndexBuffer(mesh, D3DLOCK_READONLY, &indices);
+    ok_(__FILE__, line)(hr == D3D_OK, "Got unexpected hr %#x.\n", hr);
+    for (i = 0; i < num_faces; i++)
+    {
+        if (face_remap[i] >= num_faces)
+            continue;
+
+        ok_(__FILE__, line)(attribs[i] == orig_attribs[face_remap[i]], "Face %u has attribute %u, expected %u.\n",
+                i, attribs[i], orig_attribs[face_remap[i]]);
+        if (i)
+            ok_(__FILE__, line)(attribs[i] >= attribs[i - 1], "Face %u isn't sorted by attribute.\n", i);
+
+        for (j = 0; j < 3; j++)
+        {
+            DWORD index = is_32bit ? ((DWORD *)indices)[i * 3 + j] : ((WORD *)indices)[i * 3 + j];
+            DWORD adjacent = adjacency_in[face_remap[i] * 3 + j];
+
+            ok_(__FILE__, line)(index < num_vertices && vertex_remap[index] == orig_indices[face_remap[i] * 3 + j],
+                    "Face %u index %u is %u, expected original vertex %u.\n",
+                    i, j, index, orig_indices[face_remap[i] * 3 + j]);
+            adjacent = adjacent == ~0u ? ~0u : old_to_new[adjacent];
+            ok_(__FILE__, line)(adjacency_out[i * 3 + j] == adjacent, "Face %u adjacency %u is %#x, expected %#x.\n",
+                    i, j, adjacency_out[i * 3 + j], adjacent);
+        }
+    }
+
+    /* Each attribute group covers a contiguous range of faces. */
+    hr = mesh->lpVtbl->GetAttributeTable(mesh, NULL, &attrib_table_size);
+    ok_(__FILE__, line)(hr == D3D_OK, "Got unexpected hr %#x.\n", hr);
+    ok_(__FILE__, line)(attrib_table_size && attrib_table_size <= ARRAY_SIZE(attrib_table),
+            "Got unexpected attribute table size %u.\n", attrib_table_size);
+    if (attrib_table_size && attrib_table_size <= ARRAY_SIZE(attrib_table))
+    {
+        hr = mesh->lpVtbl->GetAttributeTable(mesh, attrib_table, &attrib_table_size);
+        ok_(__FILE__, line)(hr == D3D_OK, "Got unexpected hr %#x.\n", hr);
+        for (i = 0; i < attrib_table_size; i++)
+        {
+            DWORD min_vertex = ~0u, max_vertex = 0;
+
+            ok_(__FILE__, line)(attrib_table[i].FaceStart == (i ? attrib_table[i - 1].FaceStart
+                    + attrib_table[i - 1].FaceCount : 0), "Range %u starts at face %u.\n",
+                    i, attrib_table[i].FaceStart);
+            for (j = attrib_table[i].FaceStart; j < attrib_table[i].FaceStart + attrib_table[i].FaceCount
+                    && j < num_faces; j++)
+            {
+                DWORD k, index;
+
+                ok_(__FILE__, line)(attribs[j] == attrib_table[i].AttribId, "Face %u has attribute %u, expected %u.\n",
+                        j, attribs[j], attrib_table[i].AttribId);
+                for (k = 0; k < 3; k++)
+                {
+                    index = is_32bit ? ((DWORD *)indices)[j * 3 + k] : ((WORD *)indices)[j * 3 + k];
+                    min_vertex = min(min_vertex, index);
+                    max_vertex = max(max_vertex, index);
+                }
+            }
+            ok_(__FILE__, line)(attrib_table[i].VertexStart == min_vertex
+                    && attrib_table[i].VertexCount == max_vertex - min_vertex + 1,
+                    "Range %u has vertices %u+%u, expected %u-%u.\n", i, attrib_table[i].VertexStart,
+                    attrib_table[i].VertexCount, min_vertex, max_vertex);
+        }
+        i = attrib_table_size - 1;
+        ok_(__FILE__, line)(attrib_table[i].FaceStart + attrib_table[i].FaceCount == num_faces,
+                "Attribute table covers %u faces.\n", attrib_table[i].FaceStart + attrib_table[i].FaceCount);
+    }
+
+    mesh->lpVtbl->UnlockIndexBuffer(mesh);
+    mesh->lpVtbl->UnlockAttributeBuffer(mesh);
+    HeapFree(GetProcessHeap(), 0, old_to_new);
+}
+
+static void test_optimize_inplace(void)
+{
+    static const D3DVERTEXELEMENT9 declaration[] =
+    {
+        {0, 0, D3DDECLTYPE_FLOAT3, D3DDECLMETHOD_DEFAULT, D3DDECLUSAGE_POSITION, 0},
+        D3DDECL_END()
+    };
+    /* A fan of four faces around vertex 1, in two interleaved attribute
+     * groups. Vertex 6 isn't used.
+     *
+     * 0--1--5
+     * | /|\ |
+     * |/ | \|
+     * 2--3--4
+     */
+    static const D3DXVECTOR3 vertices0[] =
+    {
+        {0.0f, 1.0f, 0.0f}, {1.0f, 1.0f, 0.0f}, {0.0f, 0.0f, 0.0f}, {1.0f, 0.0f, 0.0f},
+        {2.0f, 0.0f, 0.0f}, {2.0f, 1.0f, 0.0f}, {5.0f, 5.0f, 5.0f},
+    };
+    static const DWORD indices0[] = {0, 1, 2,  2, 1, 3,  3, 1, 4,  4, 1, 5};
+    static const WORD indices0_16[] = {0, 1, 2,  2, 1, 3,  3, 1, 4,  4, 1, 5};
+    static const DWORD attribs0[] = {1, 0, 1, 0};
+    static const DWORD adjacency0[] = {-1, 1, -1,  0, 2, -1,  1, 3, -1,  2, -1, -1};
+    static const DWORD exp_face_remap0[] = {1, 3, 0, 2};
+    static const DWORD exp_vertex_remap0[] = {2, 1, 3, 4, 5, 0, 6};
+    const DWORD num_faces0 = ARRAY_SIZE(attribs0), num_vertices0 = ARRAY_SIZE(vertices0);
+    static const struct
+    {
+        DWORD options;
+        DWORD flags;
+        DWORD num_vertices;
+    }
+    tests[] =
+    {
+        {D3DXMESH_32BIT | D3DXMESH_SYSTEMMEM, D3DXMESHOPT_ATTRSORT, 7},
+        {D3DXMESH_SYSTEMMEM, D3DXMESHOPT_ATTRSORT, 7},
+        {D3DXMESH_32BIT | D3DXMESH_SYSTEMMEM, D3DXMESHOPT_ATTRSORT | D3DXMESHOPT_COMPACT, 6},
+        {D3DXMESH_SYSTEMMEM, D3DXMESHOPT_VERTEXCACHE, 7},
+        {D3DXMESH_32BIT | D3DXMESH_SYSTEMMEM, D3DXMESHOPT_VERTEXCACHE | D3DXMESHOPT_COMPACT, 6},
+    };
+    DWORD grid_adjacency[2 * 8 * 8 * 3], grid_adjacency_out[2 * 8 * 8 * 3], grid_face_remap[2 * 8 * 8];
+    DWORD grid_indices[2 * 8 * 8 * 3], grid_attribs[2 * 8 * 8];
+    DWORD adjacency_out[ARRAY_SIZE(adjacency0)], face_remap[ARRAY_SIZE(attribs0)];
+    D3DXVECTOR3 grid_vertices[9 * 9];
+    WORD grid_indices16[ARRAY_SIZE(grid_indices)];
+    struct test_context *test_context;
+    ID3DXBuffer *vertex_remap;
+    const DWORD *remap;
+    ID3DXMesh *mesh;
+    unsigned int i, x, y;
+    DWORD size;
+    HRESULT hr;
+
+    if (!(test_context = new_test_context()))
+    {
+        skip("Couldn't create test context.\n");
+        return;
+    }
+
+    for (i = 0; i < ARRAY_SIZE(tests); ++i)
+    {
+        hr = init_test_mesh(num_faces0, num_vertices0, tests[i].options, declaration, test_context->device,
+                &mesh, vertices0, sizeof(*vertices0),
+                tests[i].options & D3DXMESH_32BIT ? indices0 : (const DWORD *)indices0_16, attribs0);
+        ok(hr == D3D_OK, "Test %u: Got unexpected hr %#x.\n", i, hr);
+        if (FAILED(hr))
+            continue;
+
+        vertex_remap = NULL;
+        memset(adjacency_out, 0xcc, sizeof(adjacency_out));
+        memset(face_remap, 0xcc, sizeof(face_remap));
+        hr = mesh->lpVtbl->OptimizeInplace(mesh, tests[i].flags, adjacency0, adjacency_out,
+                face_remap, &vertex_remap);
+        ok(hr == D3D_OK, "Test %u: Got unexpected hr %#x.\n", i, hr);
+        check_optimized_mesh(mesh, vertices0, indices0, attribs0, adjacency0, adjacency_out,
+                face_remap, vertex_remap, tests[i].num_vertices, num_vertices0);
+
+        if (!(tests[i].flags & D3DXMESHOPT_VERTEXCACHE))
+        {
+            /* The attribute sort is stable, and the vertices are ordered by
+             * their first use. */
+            ok(!memcmp(face_remap, exp_face_remap0, sizeof(face_remap)),
+                    "Test %u: Got unexpected face remap {%u, %u, %u, %u}.\n",
+                    i, face_remap[0], face_remap[1], face_remap[2], face_remap[3]);
+            if (vertex_remap)
+            {
+                remap = ID3DXBuffer_GetBufferPointer(vertex_remap);
+                for (x = 0; x < tests[i].num_vertices; ++x)
+                    ok(remap[x] == exp_vertex_remap0[x], "Test %u: Got vertex remap %#x for vertex %u, expected %#x.\n",
+                            i, remap[x], x, exp_vertex_remap0[x]);
+            }
+        }
+        if (vertex_remap)
+        {
+            remap = ID3DXBuffer_GetBufferPointer(vertex_remap);
+            size = ID3DXBuffer_GetBufferSize(vertex_remap);
+            ok(size == num_vertices0 * sizeof(DWORD), "Test %u: Got unexpected vertex remap size %u.\n", i, size);
+            if (size == num_vertices0 * sizeof(DWORD))
+            {
+                x = tests[i].flags & D3DXMESHOPT_COMPACT ? ~0u : 6;
+                ok(remap[6] == x, "Test %u: Got vertex remap %#x for the unused vertex, expected %#x.\n",
+                        i, remap[6], x);
+            }
+            ID3DXBuffer_Release(vertex_remap);
+        }
+        mesh->lpVtbl->Release(mesh);
+    }
+
+    /* An 8x8 grid of quads. Every other row of quads uses attribute 1, so
+     * that both groups are split in the original order. */
+    for (y = 0; y < 9; ++y)
+    {
+        for (x = 0; x < 9; ++x)
+        {
+            grid_vertices[y * 9 + x].x = x;
+            grid_vertices[y * 9 + x].y = y;
+            grid_vertices[y * 9 + x].z = 0.0f;
+        }
+    }
+    for (y = 0, i = 0; y < 8; ++y)
+    {
+        for (x = 0; x < 8; ++x, i += 2)
+        {
+            DWORD v = y * 9 + x;
+
+            grid_indices[i * 3 + 0] = v;
+            grid_indices[i * 3 + 1] = v + 9;
+            grid_indices[i * 3 + 2] = v + 1;
+            grid_indices[i * 3 + 3] = v + 1;
+            grid_indices[i * 3 + 4] = v + 9;
+            grid_indices[i * 3 + 5] = v + 10;
+            grid_attribs[i] = grid_attribs[i + 1] = y & 1;
+        }
+    }
+    for (i = 0; i < ARRAY_SIZE(grid_indices); ++i)
+        grid_indices16[i] = grid_indices[i];
+
+    hr = init_test_mesh(ARRAY_SIZE(grid_attribs), ARRAY_SIZE(grid_vertices), D3DXMESH_SYSTEMMEM, declaration,
+            test_context->device, &mesh, grid_vertices, sizeof(*grid_vertices), (const DWORD *)grid_indices16,
+            grid_attribs);
+    ok(hr == D3D_OK, "Got unexpected hr %#x.\n", hr);
+    if (SUCCEEDED(hr))
+    {
+        hr = mesh->lpVtbl->GenerateAdjacency(mesh, 0.0f, grid_adjacency);
+        ok(hr == D3D_OK, "Got unexpected hr %#x.\n", hr);
+
+        vertex_remap = NULL;
+        hr = mesh->lpVtbl->OptimizeInplace(mesh, D3DXMESHOPT_VERTEXCACHE, grid_adjacency, grid_adjacency_out,
+                grid_face_remap, &vertex_remap);
+        ok(hr == D3D_OK, "Got unexpected hr %#x.\n", hr);
+        check_optimized_mesh(mesh, grid_vertices, grid_indices, grid_attribs, grid_adjacency, grid_adjacency_out,
+                grid_face_remap, vertex_remap, ARRAY_SIZE(grid_vertices), ARRAY_SIZE(grid_vertices));
+        if (vertex_remap)
+            ID3DXBuffer_Release(vertex_remap);
+        mesh->lpVtbl->Release(mesh);
+    }
+
+    free_test_context(test_context);
+}
+
 static void test_compute_normals(void)
 {
     HRESULT hr;
@@ -11426,6 +11709,7 @@ START_TEST(mesh)
     test_clone_mesh();
     test_valid_mesh();
     test_optimize_faces();
+    test_optimize_inplace();
     test_compute_normals();
     test_D3DXFrameFind();
     test_load_skin_mesh_from_xof();
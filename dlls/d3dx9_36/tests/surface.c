@@ -733,6 +733,22 @@ static inline void _check_pixel_2bpp(unsigned int line, const D3DLOCKED_RECT *lo
     ok_(__FILE__, line)(color == expected_color, "Got color 0x%04x, expected 0x%04x\n", color, expected_color);
 }
 
+static BOOL compare_color(DWORD c1, DWORD c2, BYTE max_diff)
+{
+    if (abs((c1 & 0xff) - (c2 & 0xff)) > max_diff)
+        return FALSE;
+    c1 >>= 8; c2 >>= 8;
+    if (abs((c1 & 0xff) - (c2 & 0xff)) > max_diff)
+        return FALSE;
+    c1 >>= 8; c2 >>= 8;
+    if (abs((c1 & 0xff) - (c2 & 0xff)) > max_diff)
+        return FALSE;
+    c1 >>= 8; c2 >>= 8;
+    if (abs((c1 & 0xff) - (c2 & 0xff)) > max_diff)
+        return FALSE;
+    return TRUE;
+}
+
 #define check_pixel_4bpp(lockrect, x, y, color) _check_pixel_4bpp(__LINE__, lockrect, x, y, color)
 static inline void _check_pixel_4bpp(unsigned int line, const D3DLOCKED_RECT *lockrect, int x, int y, DWORD expected_color)
 {
@@ -740,6 +756,198 @@ static inline void _check_pixel_4bpp(unsigned int line, const D3DLOCKED_RECT *lo
    ok_(__FILE__, line)(color == expected_color, "Got color 0x%08x, expected 0x%08x\n", color, expected_color);
 }
 
+#define check_pixel_4bpp_diff(lockrect, x, y, color, max_diff) \
+        _check_pixel_4bpp_diff(__LINE__, lockrect, x, y, color, max_diff)
+static inline void _check_pixel_4bpp_diff(unsigned int line, const D3DLOCKED_RECT *lockrect, int x, int y,
+        DWORD expected_color, BYTE max_diff)
+{
+   DWORD color = ((DWORD*)lockrect->pBits)[x + y * lockrect->Pitch / 4];
+   ok_(__FILE__, line)(compare_color(color, expected_color, max_diff),
+           "Got color 0x%08x, expected 0x%08x\n", color, expected_color);
+}
+
+static void test_dxtn_compression_rows(IDirect3DDevice9 *device, D3DFORMAT format)
+{
+    unsigned int block_size = format == D3DFMT_DXT1 ? 8 : 16;
+    IDirect3DSurface9 *surface, *row_surface;
+    IDirect3DTexture9 *texture, *row_texture;
+    D3DLOCKED_RECT lockrect, row_lockrect;
+    unsigned int x, y;
+    DWORD *pixels;
+    HRESULT hr;
+    RECT rect;
+
+    /* Taller than the height compressed by a single work item in the builtin
+     * implementation, so that the image is compressed in several parts. */
+    if (!(pixels = HeapAlloc(GetProcessHeap(), 0, 64 * 96 * sizeof(*pixels))))
+        return;
+    for (y = 0; y < 96; ++y)
+    {
+        for (x = 0; x < 64; ++x)
+            pixels[y * 64 + x] = (((x * 7 + y * 3) & 0xff) << 24) | ((x * 4) << 16)
+                    | (((y * 8 / 3) & 0xff) << 8) | ((x * y) & 0xff);
+    }
+
+    hr = IDirect3DDevice9_CreateTexture(device, 64, 96, 1, 0, format, D3DPOOL_SYSTEMMEM, &texture, NULL);
+    if (FAILED(hr))
+    {
+        skip("Failed to create texture with format %#x, hr %#x.\n", format, hr);
+        HeapFree(GetProcessHeap(), 0, pixels);
+        return;
+    }
+    hr = IDirect3DDevice9_CreateTexture(device, 64, 96, 1, 0, format, D3DPOOL_SYSTEMMEM, &row_texture, NULL);
+    ok(hr == D3D_OK, "Got unexpected hr %#x.\n", hr);
+    hr = IDirect3DTexture9_GetSurfaceLevel(texture, 0, &surface);
+    ok(hr == D3D_OK, "Got unexpected hr %#x.\n", hr);
+    hr = IDirect3DTexture9_GetSurfaceLevel(row_texture, 0, &row_surface);
+    ok(hr == D3D_OK, "Got unexpected hr %#x.\n", hr);
+
+    SetRect(&rect, 0, 0, 64, 96);
+    hr = D3DXLoadSurfaceFromMemory(surface, NULL, NULL, pixels, D3DFMT_A8R8G8B8, 64 * sizeof(*pixels),
+            NULL, &rect, D3DX_FILTER_NONE, 0);
+    ok(hr == D3D_OK, "Got unexpected hr %#x.\n", hr);
+
+    /* Compress each row of blocks on its own. */
+    for (y = 0; y < 96; y += 4)
+    {
+        SetRect(&rect, 0, y, 64, y + 4);
+        hr = D3DXLoadSurfaceFromMemory(row_surface, NULL, &rect, pixels, D3DFMT_A8R8G8B8, 64 * sizeof(*pixels),
+                NULL, &rect, D3DX_FILTER_NONE, 0);
+        ok(hr == D3D_OK, "Got unexpected hr %#x.\n", hr);
+    }
+
+    hr = IDirect3DSurface9_LockRect(surface, &lockrect, NULL, D3DLOCK_READONLY);
+    ok(hr == D3D_OK, "Got unexpected hr %#x.\n", hr);
+    hr = IDirect3DSurface9_LockRect(row_surface, &row_lockrect, NULL, D3DLOCK_READONLY);
+    ok(hr == D3D_OK, "Got unexpected hr %#x.\n", hr);
+    for (y = 0; y < 96 / 4; ++y)
+    {
+        ok(!memcmp((BYTE *)lockrect.pBits + y * lockrect.Pitch, (BYTE *)row_lockrect.pBits + y * row_lockrect.Pitch,
+                64 / 4 * block_size), "Format %#x: blocks in row %u differ.\n", format, y);
+    }
+    IDirect3DSurface9_UnlockRect(row_surface);
+    IDirect3DSurface9_UnlockRect(surface);
+
+    check_release((IUnknown *)row_surface, 1);
+    check_release((IUnknown *)row_texture, 0);
+    check_release((IUnknown *)surface, 1);
+    check_release((IUnknown *)texture, 0);
+    HeapFree(GetProcessHeap(), 0, pixels);
+}
+
+static void test_dxtn_compression_error(IDirect3DDevice9 *device, D3DFORMAT format)
+{
+    IDirect3DSurface9 *surface, *decompressed;
+    D3DLOCKED_RECT lockrect, dxt_lockrect;
+    unsigned int x, y;
+    DWORD *pixels;
+    HRESULT hr;
+    RECT rect;
+
+    /* Smooth gradients are encoded closely by any reasonable endpoint search;
+     * the tolerance covers the RGB565 quantization and the interpolated
+     * palette entries. */
+    if (!(pixels = HeapAlloc(GetProcessHeap(), 0, 64 * 64 * sizeof(*pixels))))
+        return;
+    for (y = 0; y < 64; ++y)
+    {
+        for (x = 0; x < 64; ++x)
+            pixels[y * 64 + x] = ((0xff - x * 2) << 24) | ((x * 3) << 16) | ((y * 3) << 8) | ((x + y) * 3 / 2);
+    }
+
+    hr = IDirect3DDevice9_CreateOffscreenPlainSurface(device, 64, 64, format, D3DPOOL_SYSTEMMEM, &surface, NULL);
+    if (FAILED(hr))
+    {
+        skip("Failed to create surface with format %#x, hr %#x.\n", format, hr);
+        HeapFree(GetProcessHeap(), 0, pixels);
+        return;
+    }
+    hr = IDirect3DDevice9_CreateOffscreenPlainSurface(device, 64, 64, D3DFMT_A8R8G8B8, D3DPOOL_SYSTEMMEM,
+            &decompressed, NULL);
+    ok(hr == D3D_OK, "Got unexpected hr %#x.\n", hr);
+
+    SetRect(&rect, 0, 0, 64, 64);
+    hr = D3DXLoadSurfaceFromMemory(surface, NULL, NULL, pixels, D3DFMT_A8R8G8B8, 64 * sizeof(*pixels),
+            NULL, &rect, D3DX_FILTER_NONE, 0);
+    ok(hr == D3D_OK, "Got unexpected hr %#x.\n", hr);
+
+    hr = IDirect3DSurface9_LockRect(surface, &dxt_lockrect, NULL, D3DLOCK_READONLY);
+    ok(hr == D3D_OK, "Got unexpected hr %#x.\n", hr);
+    hr = D3DXLoadSurfaceFromMemory(decompressed, NULL, NULL, dxt_lockrect.pBits, format, dxt_lockrect.Pitch,
+            NULL, &rect, D3DX_FILTER_NONE, 0);
+    ok(hr == D3D_OK, "Got unexpected hr %#x.\n", hr);
+    IDirect3DSurface9_UnlockRect(surface);
+
+    hr = IDirect3DSurface9_LockRect(decompressed, &lockrect, NULL, D3DLOCK_READONLY);
+    ok(hr == D3D_OK, "Got unexpected hr %#x.\n", hr);
+    for (y = 0; y < 64; ++y)
+    {
+        for (x = 0; x < 64; ++x)
+        {
+            DWORD expected = pixels[y * 64 + x];
+
+            /* All source alpha values are above the DXT1 punch-through threshold. */
+            if (format == D3DFMT_DXT1)
+                expected |= 0xff000000;
+            check_pixel_4bpp_diff(&lockrect, x, y, expected, 16);
+        }
+    }
+    IDirect3DSurface9_UnlockRect(decompressed);
+
+    check_release((IUnknown *)decompressed, 0);
+    check_release((IUnknown *)surface, 0);
+    HeapFree(GetProcessHeap(), 0, pixels);
+}
+
+static void test_dxtn_fast_compression(void)
+{
+    static const char fast[] = "fast";
+    char cmdline[MAX_PATH * 2], old_value[16], **argv;
+    DWORD old_type, old_size = sizeof(old_value);
+    PROCESS_INFORMATION pi;
+    STARTUPINFOA si = {0};
+    HKEY key;
+    LONG res;
+    BOOL ret;
+
+    /* The compression quality is a Wine extension that native ignores. It is
+     * read once per process, so the fast encoder is tested in a child process. */
+    res = RegCreateKeyExA(HKEY_CURRENT_USER, "Software\\Wine\\Direct3D", 0, NULL, 0,
+            KEY_QUERY_VALUE | KEY_SET_VALUE, NULL, &key, NULL);
+    if (res)
+    {
+        skip("Failed to create the Direct3D key, error %d.\n", res);
+        return;
+    }
+    res = RegQueryValueExA(key, "DXTnCompressionQuality", NULL, &old_type, (BYTE *)old_value, &old_size);
+    if (res == ERROR_MORE_DATA)
+    {
+        skip("DXTnCompressionQuality value is too large to be restored.\n");
+        RegCloseKey(key);
+        return;
+    }
+    ret = !RegSetValueExA(key, "DXTnCompressionQuality", 0, REG_SZ, (const BYTE *)fast, sizeof(fast));
+    ok(ret, "Failed to set the compression quality.\n");
+
+    winetest_get_mainargs(&argv);
+    sprintf(cmdline, "\"%s\" surface dxtn_fast", argv[0]);
+    si.cb = sizeof(si);
+    ret = CreateProcessA(NULL, cmdline, NULL, NULL, FALSE, 0, NULL, NULL, &si, &pi);
+    ok(ret, "Failed to create process, error %u.\n", GetLastError());
+    if (ret)
+    {
+        winetest_wait_child_process(pi.hProcess);
+        CloseHandle(pi.hProcess);
+        CloseHandle(pi.hThread);
+    }
+
+    if (!res)
+        RegSetValueExA(key, "DXTnCompressionQuality", 0, old_type, (BYTE *)old_value, old_size);
+    else
+        RegDeleteValueA(key, "DXTnCompressionQuality");
+    RegCloseKey(key);
+}
+
 static void test_D3DXLoadSurface(IDirect3DDevice9 *device)
 {
     HRESULT hr;
@@ -754,7 +962,13 @@ static void test_D3DXLoadSurface(IDirect3DDevice9 *device)
     static const WORD pixdata_a8l8[] = { 0xff00, 0x00ff, 0xff30, 0x7f7f };
     static const DWORD pixdata_g16r16[] = { 0x07d23fbe, 0xdc7f44a4, 0xe4d8976b, 0x9a84fe89 };
     static const DWORD pixdata_a8b8g8r8[] = { 0xc3394cf0, 0x235ae892, 0x09b197fd, 0x8dc32bf6 };
+    static const DWORD pixdata_box[] = { 0x00000000, 0x40201000, 0x80603000, 0xc0804040 };
+    static const DWORD pixdata_magnify[] = { 0xff000000, 0xff800000, 0xff008000, 0xff808000 };
+    static const WORD pixdata_a4r4g4b4[] = { 0x0123, 0x2345, 0x4567, 0x6789 };
+    static const DWORD magnified[] = { 0x00, 0x20, 0x60, 0x80 };
     static const DWORD pixdata_a2r10g10b10[] = { 0x57395aff, 0x5b7668fd, 0xb0d856b5, 0xff2c61d6 };
+    DWORD pixdata_gradient[16], pixdata_const[16], color, color2;
+    unsigned int x, y;
 
     hr = create_file("testdummy.bmp", noimage, sizeof(noimage));  /* invalid image */
     testdummy_ok = SUCCEEDED(hr);
@@ -953,6 +1167,103 @@ static void test_D3DXLoadSurface(IDirect3DDevice9 *device)
     IDirect3DSurface9_LockRect(surf, &lockrect, NULL, D3DLOCK_READONLY);
     check_pixel_4bpp(&lockrect, 0, 0, 0x8dc32bf6);
     IDirect3DSurface9_UnlockRect(surf);
+
+    /* Filtering. The expected colors follow from the filter definitions; allow
+     * for rounding differences. */
+    SetRect(&rect, 0, 0, 2, 2);
+    hr = D3DXLoadSurfaceFromMemory(surf, NULL, NULL, pixdata_box,
+            D3DFMT_A8R8G8B8, 8, NULL, &rect, D3DX_FILTER_BOX, 0);
+    ok(hr == D3D_OK, "Got unexpected hr %#x.\n", hr);
+    IDirect3DSurface9_LockRect(surf, &lockrect, NULL, D3DLOCK_READONLY);
+    check_pixel_4bpp_diff(&lockrect, 0, 0, 0x60402010, 1);
+    IDirect3DSurface9_UnlockRect(surf);
+
+    hr = D3DXLoadSurfaceFromMemory(surf, NULL, NULL, pixdata_box,
+            D3DFMT_A8R8G8B8, 8, NULL, &rect, D3DX_FILTER_LINEAR, 0);
+    ok(hr == D3D_OK, "Got unexpected hr %#x.\n", hr);
+    IDirect3DSurface9_LockRect(surf, &lockrect, NULL, D3DLOCK_READONLY);
+    check_pixel_4bpp_diff(&lockrect, 0, 0, 0x60402010, 1);
+    IDirect3DSurface9_UnlockRect(surf);
+    check_release((IUnknown *)surf, 0);
+
+    /* Filtering with sizes and formats that don't take the 2x2 averaging path. */
+    for (y = 0; y < 4; ++y)
+    {
+        for (x = 0; x < 4; ++x)
+        {
+            pixdata_gradient[y * 4 + x] = 0xff000010 | (x * 0x40) << 16 | (y * 0x40) << 8;
+            pixdata_const[y * 4 + x] = 0x80402010;
+        }
+    }
+
+    hr = IDirect3DDevice9_CreateOffscreenPlainSurface(device, 3, 3, D3DFMT_A8R8G8B8, D3DPOOL_DEFAULT, &surf, NULL);
+    ok(hr == D3D_OK, "Got unexpected hr %#x.\n", hr);
+    SetRect(&rect, 0, 0, 4, 4);
+    hr = D3DXLoadSurfaceFromMemory(surf, NULL, NULL, pixdata_gradient,
+            D3DFMT_A8R8G8B8, 16, NULL, &rect, D3DX_FILTER_TRIANGLE, 0);
+    ok(hr == D3D_OK, "Got unexpected hr %#x.\n", hr);
+    IDirect3DSurface9_LockRect(surf, &lockrect, NULL, D3DLOCK_READONLY);
+    check_pixel_4bpp_diff(&lockrect, 1, 1, 0xff606010, 2);
+    /* The gradients are linear, so the borders are symmetric around the center. */
+    color = ((DWORD *)lockrect.pBits)[lockrect.Pitch / 4];
+    color2 = ((DWORD *)lockrect.pBits)[2 + lockrect.Pitch / 4];
+    ok(abs((int)((color >> 16) & 0xff) + (int)((color2 >> 16) & 0xff) - 0xc0) <= 2,
+            "Got colors 0x%08x, 0x%08x.\n", color, color2);
+    color = ((DWORD *)lockrect.pBits)[1];
+    color2 = ((DWORD *)lockrect.pBits)[1 + lockrect.Pitch / 2];
+    ok(abs((int)((color >> 8) & 0xff) + (int)((color2 >> 8) & 0xff) - 0xc0) <= 2,
+            "Got colors 0x%08x, 0x%08x.\n", color, color2);
+    IDirect3DSurface9_UnlockRect(surf);
+
+    hr = D3DXLoadSurfaceFromMemory(surf, NULL, NULL, pixdata_const,
+            D3DFMT_A8R8G8B8, 16, NULL, &rect, D3DX_FILTER_BOX, 0);
+    ok(hr == D3D_OK, "Got unexpected hr %#x.\n", hr);
+    IDirect3DSurface9_LockRect(surf, &lockrect, NULL, D3DLOCK_READONLY);
+    for (y = 0; y < 3; ++y)
+    {
+        for (x = 0; x < 3; ++x)
+            check_pixel_4bpp_diff(&lockrect, x, y, 0x80402010, 1);
+    }
+    IDirect3DSurface9_UnlockRect(surf);
+    check_release((IUnknown *)surf, 0);
+
+    hr = IDirect3DDevice9_CreateOffscreenPlainSurface(device, 4, 4, D3DFMT_A8R8G8B8, D3DPOOL_DEFAULT, &surf, NULL);
+    ok(hr == D3D_OK, "Got unexpected hr %#x.\n", hr);
+    SetRect(&rect, 0, 0, 2, 2);
+    hr = D3DXLoadSurfaceFromMemory(surf, NULL, NULL, pixdata_magnify,
+            D3DFMT_A8R8G8B8, 8, NULL, &rect, D3DX_FILTER_LINEAR, 0);
+    ok(hr == D3D_OK, "Got unexpected hr %#x.\n", hr);
+    IDirect3DSurface9_LockRect(surf, &lockrect, NULL, D3DLOCK_READONLY);
+    for (y = 0; y < 4; ++y)
+    {
+        for (x = 0; x < 4; ++x)
+            check_pixel_4bpp_diff(&lockrect, x, y, 0xff000000 | magnified[x] << 16 | magnified[y] << 8, 4);
+    }
+    IDirect3DSurface9_UnlockRect(surf);
+    check_release((IUnknown *)surf, 0);
+
+    hr = IDirect3DDevice9_CreateOffscreenPlainSurface(device, 1, 1, D3DFMT_A8R8G8B8, D3DPOOL_DEFAULT, &surf, NULL);
+    ok(hr == D3D_OK, "Got unexpected hr %#x.\n", hr);
+    hr = D3DXLoadSurfaceFromMemory(surf, NULL, NULL, pixdata_box,
+            D3DFMT_X8R8G8B8, 8, NULL, &rect, D3DX_FILTER_BOX, 0);
+    ok(hr == D3D_OK, "Got unexpected hr %#x.\n", hr);
+    IDirect3DSurface9_LockRect(surf, &lockrect, NULL, D3DLOCK_READONLY);
+    check_pixel_4bpp_diff(&lockrect, 0, 0, 0xff402010, 1);
+    IDirect3DSurface9_UnlockRect(surf);
+
+    hr = D3DXLoadSurfaceFromMemory(surf, NULL, NULL, pixdata_box,
+            D3DFMT_X8R8G8B8, 8, NULL, &rect, D3DX_FILTER_LINEAR, 0);
+    ok(hr == D3D_OK, "Got unexpected hr %#x.\n", hr);
+    IDirect3DSurface9_LockRect(surf, &lockrect, NULL, D3DLOCK_READONLY);
+    check_pixel_4bpp_diff(&lockrect, 0, 0, 0xff402010, 1);
+    IDirect3DSurface9_UnlockRect(surf);
+
+    hr = D3DXLoadSurfaceFromMemory(surf, NULL, NULL, pixdata_a4r4g4b4,
+            D3DFMT_A4R4G4B4, 4, NULL, &rect, D3DX_FILTER_BOX, 0);
+    ok(hr == D3D_OK, "Got unexpected hr %#x.\n", hr);
+    IDirect3DSurface9_LockRect(surf, &lockrect, NULL, D3DLOCK_READONLY);
+    check_pixel_4bpp_diff(&lockrect, 0, 0, 0x33445566, 0x11);
+    IDirect3DSurface9_UnlockRect(surf);
     check_release((IUnknown *)surf, 0);
 
     /* test color conversion */
@@ -1631,6 +1942,8 @@ START_TEST(surface)
     IDirect3DDevice9 *device;
     D3DPRESENT_PARAMETERS d3dpp;
     HRESULT hr;
+    char **argv;
+    int argc;
 
     if (!(wnd = CreateWindowA("static", "d3dx9_test", WS_OVERLAPPEDWINDOW, 0, 0,
             640, 480, NULL, NULL, NULL, NULL)))
@@ -1656,11 +1969,26 @@ START_TEST(surface)
         return;
     }
 
+    argc = winetest_get_mainargs(&argv);
+    if (argc >= 3 && !strcmp(argv[2], "dxtn_fast"))
+    {
+        test_dxtn_compression_rows(device, D3DFMT_DXT1);
+        test_dxtn_compression_error(device, D3DFMT_DXT1);
+        test_dxtn_compression_error(device, D3DFMT_DXT5);
+        goto done;
+    }
+
     test_D3DXGetImageInfo();
     test_D3DXLoadSurface(device);
+    test_dxtn_compression_rows(device, D3DFMT_DXT1);
+    test_dxtn_compression_rows(device, D3DFMT_DXT5);
+    test_dxtn_compression_error(device, D3DFMT_DXT1);
+    test_dxtn_compression_error(device, D3DFMT_DXT5);
+    test_dxtn_fast_compression();
     test_D3DXSaveSurfaceToFileInMemory(device);
     test_D3DXSaveSurfaceToFile(device);
 
+done:
     check_release((IUnknown*)device, 0);
     check_release((IUnknown*)d3d, 0);
     DestroyWindow(wnd);
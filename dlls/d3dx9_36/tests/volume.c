@@ -39,6 +39,22 @@ static const unsigned char dds_volume_map[] =
     0x0f,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x10,0x84,0xef,0x7b,0xaa,0xab,0xab,0xab
 };
 
+static BOOL compare_color(DWORD c1, DWORD c2, BYTE max_diff)
+{
+    if (abs((c1 & 0xff) - (c2 & 0xff)) > max_diff)
+        return FALSE;
+    c1 >>= 8; c2 >>= 8;
+    if (abs((c1 & 0xff) - (c2 & 0xff)) > max_diff)
+        return FALSE;
+    c1 >>= 8; c2 >>= 8;
+    if (abs((c1 & 0xff) - (c2 & 0xff)) > max_diff)
+        return FALSE;
+    c1 >>= 8; c2 >>= 8;
+    if (abs((c1 & 0xff) - (c2 & 0xff)) > max_diff)
+        return FALSE;
+    return TRUE;
+}
+
 #define check_pixel_4bpp(box, x, y, z, color) _check_pixel_4bpp(__LINE__, box, x, y, z, color)
 static inline void _check_pixel_4bpp(unsigned int line, const D3DLOCKED_BOX *box, int x, int y, int z, DWORD expected_color)
 {
@@ -46,6 +62,16 @@ static inline void _check_pixel_4bpp(unsigned int line, const D3DLOCKED_BOX *box
    ok_(__FILE__, line)(color == expected_color, "Got color 0x%08x, expected 0x%08x\n", color, expected_color);
 }
 
+#define check_pixel_4bpp_diff(box, x, y, z, color, max_diff) \
+        _check_pixel_4bpp_diff(__LINE__, box, x, y, z, color, max_diff)
+static inline void _check_pixel_4bpp_diff(unsigned int line, const D3DLOCKED_BOX *box, int x, int y, int z,
+        DWORD expected_color, BYTE max_diff)
+{
+   DWORD color = ((DWORD *)box->pBits)[x + (y * box->RowPitch + z * box->SlicePitch) / 4];
+   ok_(__FILE__, line)(compare_color(color, expected_color, max_diff),
+           "Got color 0x%08x, expected 0x%08x\n", color, expected_color);
+}
+
 static inline void set_box(D3DBOX *box, UINT left, UINT top, UINT right, UINT bottom, UINT front, UINT back)
 {
     box->Left = left;
@@ -68,6 +94,8 @@ static void test_D3DXLoadVolumeFromMemory(IDirect3DDevice9 *device)
                              0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff,
                              0x00000000, 0x00000000, 0x00000000, 0xffffffff,
                              0xffffffff, 0x00000000, 0xffffffff, 0x00000000 };
+    static const DWORD filter_pixels[] = { 0x00000000, 0x10101010, 0x20202020, 0x30303030,
+                                           0x40404040, 0x50505050, 0x60606060, 0x70707070 };
 
     hr = IDirect3DDevice9_CreateVolumeTexture(device, 256, 256, 4, 1, D3DUSAGE_DYNAMIC, D3DFMT_A8R8G8B8, D3DPOOL_DEFAULT,
             &volume_texture, NULL);
@@ -147,6 +175,30 @@ static void test_D3DXLoadVolumeFromMemory(IDirect3DDevice9 *device)
     for (i = 0; i < 4; i++) check_pixel_4bpp(&locked_box, i % 2, i / 2, 0, pixels[i + 8]);
     IDirect3DVolume9_UnlockBox(volume);
 
+    /* Filtering. */
+    set_box(&src_box, 0, 0, 2, 2, 0, 2);
+    set_box(&dst_box, 0, 0, 1, 1, 0, 1);
+    hr = D3DXLoadVolumeFromMemory(volume, NULL, &dst_box, filter_pixels, D3DFMT_A8R8G8B8, 8, 16, NULL, &src_box,
+            D3DX_FILTER_BOX, 0);
+    ok(hr == D3D_OK, "D3DXLoadVolumeFromMemory returned %#x, expected %#x\n", hr, D3D_OK);
+    IDirect3DVolume9_LockBox(volume, &locked_box, &dst_box, D3DLOCK_READONLY);
+    check_pixel_4bpp_diff(&locked_box, 0, 0, 0, 0x38383838, 1);
+    IDirect3DVolume9_UnlockBox(volume);
+
+    hr = D3DXLoadVolumeFromMemory(volume, NULL, &dst_box, filter_pixels, D3DFMT_A8R8G8B8, 8, 16, NULL, &src_box,
+            D3DX_FILTER_LINEAR, 0);
+    ok(hr == D3D_OK, "D3DXLoadVolumeFromMemory returned %#x, expected %#x\n", hr, D3D_OK);
+    IDirect3DVolume9_LockBox(volume, &locked_box, &dst_box, D3DLOCK_READONLY);
+    check_pixel_4bpp_diff(&locked_box, 0, 0, 0, 0x38383838, 1);
+    IDirect3DVolume9_UnlockBox(volume);
+
+    hr = D3DXLoadVolumeFromMemory(volume, NULL, &dst_box, filter_pixels, D3DFMT_X8R8G8B8, 8, 16, NULL, &src_box,
+            D3DX_FILTER_TRIANGLE, 0);
+    ok(hr == D3D_OK, "D3DXLoadVolumeFromMemory returned %#x, expected %#x\n", hr, D3D_OK);
+    IDirect3DVolume9_LockBox(volume, &locked_box, &dst_box, D3DLOCK_READONLY);
+    check_pixel_4bpp_diff(&locked_box, 0, 0, 0, 0xff383838, 1);
+    IDirect3DVolume9_UnlockBox(volume);
+
     set_box(&src_box, 0, 0, 4, 1, 0, 4);
 
     set_box(&dst_box, -1, -1, 3, 0, 0, 4);
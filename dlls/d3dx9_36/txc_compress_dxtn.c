@@ -24,6 +24,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <math.h>
 #include "txc_dxtn.h"
 
 /* weights used for error function, basically weights (unsquared 2/4/1) according to rgb->luminance conversion
@@ -404,6 +405,115 @@ static void encodedxtcolorblockfaster( GLubyte *blkaddr, GLubyte srccolors[4][4]
    storedxtencodedblock(blkaddr, srccolors, bestcolor, numxpixels, numypixels, type, haveAlpha);
 }
 
+static void encodedxtcolorblockrangefit( GLubyte *blkaddr, GLubyte srccolors[4][4][4],
+                         GLint numxpixels, GLint numypixels, GLuint type )
+{
+/* "range fit": use the extremes of the block along its principal axis as base colors.
+   Much cheaper than the search above, at some loss of quality for blocks with
+   several distinct colors. The error function weights squared channel differences
+   by REDWEIGHT, GREENWEIGHT and BLUEWEIGHT; scaling each channel by the square root
+   of its weight makes plain squared distances in the scaled space match that error,
+   so the principal axis is computed there. */
+   static const GLfloat weight[3] = {2.0f, 4.0f, 1.0f}; /* sqrt(4), sqrt(16), sqrt(1) */
+   GLfloat mean[3] = {0.0f, 0.0f, 0.0f}, cov[6] = {0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+   GLfloat axis[3], v[3], t[3], proj, minproj, maxproj, len;
+   GLubyte *bestcolor[2];
+   GLubyte basecolors[2][3];
+   GLint i, j, c, iter, count = 0;
+   GLboolean haveAlpha = GL_FALSE;
+
+   for (j = 0; j < numypixels; j++) {
+      for (i = 0; i < numxpixels; i++) {
+         if ((type == GL_COMPRESSED_RGBA_S3TC_DXT1_EXT) && (srccolors[j][i][3] <= ALPHACUT)) {
+            haveAlpha = GL_TRUE;
+            continue;
+         }
+         for (c = 0; c < 3; c++)
+            mean[c] += srccolors[j][i][c] * weight[c];
+         count++;
+      }
+   }
+
+   if (!count) {
+      /* everything is transparent, the colors don't matter */
+      for (c = 0; c < 3; c++)
+         basecolors[0][c] = basecolors[1][c] = 0;
+      goto store;
+   }
+
+   for (c = 0; c < 3; c++)
+      mean[c] /= count;
+
+   for (j = 0; j < numypixels; j++) {
+      for (i = 0; i < numxpixels; i++) {
+         if ((type == GL_COMPRESSED_RGBA_S3TC_DXT1_EXT) && (srccolors[j][i][3] <= ALPHACUT))
+            continue;
+         for (c = 0; c < 3; c++)
+            v[c] = srccolors[j][i][c] * weight[c] - mean[c];
+         cov[0] += v[0] * v[0];
+         cov[1] += v[0] * v[1];
+         cov[2] += v[0] * v[2];
+         cov[3] += v[1] * v[1];
+         cov[4] += v[1] * v[2];
+         cov[5] += v[2] * v[2];
+      }
+   }
+
+   /* principal axis by power iteration, starting from the covariance matrix
+      column with the largest variance */
+   if (cov[0] >= cov[3] && cov[0] >= cov[5]) {
+      axis[0] = cov[0]; axis[1] = cov[1]; axis[2] = cov[2];
+   }
+   else if (cov[3] >= cov[5]) {
+      axis[0] = cov[1]; axis[1] = cov[3]; axis[2] = cov[4];
+   }
+   else {
+      axis[0] = cov[2]; axis[1] = cov[4]; axis[2] = cov[5];
+   }
+   for (iter = 0; iter < 4; iter++) {
+      t[0] = cov[0] * axis[0] + cov[1] * axis[1] + cov[2] * axis[2];
+      t[1] = cov[1] * axis[0] + cov[3] * axis[1] + cov[4] * axis[2];
+      t[2] = cov[2] * axis[0] + cov[4] * axis[1] + cov[5] * axis[2];
+      len = fabsf(t[0]);
+      if (fabsf(t[1]) > len) len = fabsf(t[1]);
+      if (fabsf(t[2]) > len) len = fabsf(t[2]);
+      if (len == 0.0f) break;
+      for (c = 0; c < 3; c++)
+         axis[c] = t[c] / len;
+   }
+
+   minproj = maxproj = 0.0f;
+   for (j = 0; j < numypixels; j++) {
+      for (i = 0; i < numxpixels; i++) {
+         if ((type == GL_COMPRESSED_RGBA_S3TC_DXT1_EXT) && (srccolors[j][i][3] <= ALPHACUT))
+            continue;
+         proj = 0.0f;
+         for (c = 0; c < 3; c++)
+            proj += (srccolors[j][i][c] * weight[c] - mean[c]) * axis[c];
+         if (proj < minproj) minproj = proj;
+         if (proj > maxproj) maxproj = proj;
+      }
+   }
+
+   len = axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2];
+   if (len > 0.0f) {
+      minproj /= len;
+      maxproj /= len;
+   }
+   for (c = 0; c < 3; c++) {
+      GLfloat low = (mean[c] + axis[c] * minproj) / weight[c];
+      GLfloat high = (mean[c] + axis[c] * maxproj) / weight[c];
+
+      basecolors[0][c] = low <= 0.0f ? 0 : low >= 255.0f ? 255 : (GLubyte)(low + 0.5f);
+      basecolors[1][c] = high <= 0.0f ? 0 : high >= 255.0f ? 255 : (GLubyte)(high + 0.5f);
+   }
+
+store:
+   bestcolor[0] = basecolors[0];
+   bestcolor[1] = basecolors[1];
+   storedxtencodedblock(blkaddr, srccolors, bestcolor, numxpixels, numypixels, type, haveAlpha);
+}
+
 static void writedxt5encodedalphablock( GLubyte *blkaddr, GLubyte alphabase1, GLubyte alphabase2,
                          GLubyte alphaenc[16])
 {
@@ -756,7 +866,7 @@ static void extractsrccolors( GLubyte srcpixels[4][4][4], const GLchan *srcaddr,
 
 
 void tx_compress_dxtn(GLint srccomps, GLint width, GLint height, const GLubyte *srcPixData,
-                     GLenum destFormat, GLubyte *dest, GLint dstRowStride)
+                     GLenum destFormat, GLubyte *dest, GLint dstRowStride, GLboolean fast)
 {
       GLubyte *blkaddr = dest;
       GLubyte srcpixels[4][4][4];
@@ -780,7 +890,10 @@ void tx_compress_dxtn(GLint srccomps, GLint width, GLint height, const GLubyte *
             if (width > i + 3) numxpixels = 4;
             else numxpixels = width - i;
             extractsrccolors(srcpixels, srcaddr, width, numxpixels, numypixels, srccomps);
-            encodedxtcolorblockfaster(blkaddr, srcpixels, numxpixels, numypixels, destFormat);
+            if (fast)
+               encodedxtcolorblockrangefit(blkaddr, srcpixels, numxpixels, numypixels, destFormat);
+            else
+               encodedxtcolorblockfaster(blkaddr, srcpixels, numxpixels, numypixels, destFormat);
             srcaddr += srccomps * numxpixels;
             blkaddr += 8;
          }
@@ -807,7 +920,10 @@ void tx_compress_dxtn(GLint srccomps, GLint width, GLint height, const GLubyte *
             *blkaddr++ = (srcpixels[2][2][3] >> 4) | (srcpixels[2][3][3] & 0xf0);
             *blkaddr++ = (srcpixels[3][0][3] >> 4) | (srcpixels[3][1][3] & 0xf0);
             *blkaddr++ = (srcpixels[3][2][3] >> 4) | (srcpixels[3][3][3] & 0xf0);
-            encodedxtcolorblockfaster(blkaddr, srcpixels, numxpixels, numypixels, destFormat);
+            if (fast)
+               encodedxtcolorblockrangefit(blkaddr, srcpixels, numxpixels, numypixels, destFormat);
+            else
+               encodedxtcolorblockfaster(blkaddr, srcpixels, numxpixels, numypixels, destFormat);
             srcaddr += srccomps * numxpixels;
             blkaddr += 8;
          }
@@ -827,7 +943,10 @@ void tx_compress_dxtn(GLint srccomps, GLint width, GLint height, const GLubyte *
             else numxpixels = width - i;
             extractsrccolors(srcpixels, srcaddr, width, numxpixels, numypixels, srccomps);
             encodedxt5alpha(blkaddr, srcpixels, numxpixels, numypixels);
-            encodedxtcolorblockfaster(blkaddr + 8, srcpixels, numxpixels, numypixels, destFormat);
+            if (fast)
+               encodedxtcolorblockrangefit(blkaddr + 8, srcpixels, numxpixels, numypixels, destFormat);
+            else
+               encodedxtcolorblockfaster(blkaddr + 8, srcpixels, numxpixels, numypixels, destFormat);
             srcaddr += srccomps * numxpixels;
             blkaddr += 16;
          }
@@ -47,6 +47,6 @@ void fetch_2d_texel_rgba_dxt5(GLint srcRowStride, const GLubyte *pixdata,
 
 void tx_compress_dxtn(GLint srccomps, GLint width, GLint height,
 		      const GLubyte *srcPixData, GLenum destformat,
-		      GLubyte *dest, GLint dstRowStride);
+		      GLubyte *dest, GLint dstRowStride, GLboolean fast);
 
 #endif /* _TXC_DXTN_H */
@@ -1143,6 +1143,7 @@ void secondarybuffer_destroy(IDirectSoundBufferImpl *This)
 
     HeapFree(GetProcessHeap(), 0, This->notifies);
     HeapFree(GetProcessHeap(), 0, This->pwfx);
+    HeapFree(GetProcessHeap(), 0, This->fir_phases);
 
     if (This->filters) {
         int i;
@@ -1199,6 +1200,7 @@ HRESULT IDirectSoundBufferImpl_Duplicate(
     dsb->sec_mixpos = 0;
     dsb->notifies = NULL;
     dsb->nrofnotifies = 0;
+    dsb->fir_phases = NULL;
     dsb->device = device;
     DSOUND_RecalcFormat(dsb);
 
@@ -100,6 +100,61 @@ static float getieee32(const IDirectSoundBufferImpl *dsb, DWORD pos, DWORD chann
 
 const bitsgetfunc getbpp[5] = {get8, get16, get24, get32, getieee32};
 
+/* The block versions convert count samples of one channel, istride bytes
+ * apart, to floats ostride floats apart. */
+static void get8_block(const BYTE *src, UINT istride, float *dst, UINT ostride, UINT count)
+{
+    while (count--)
+    {
+        *dst = (*src - 0x80) / (float)0x80;
+        src += istride;
+        dst += ostride;
+    }
+}
+
+static void get16_block(const BYTE *src, UINT istride, float *dst, UINT ostride, UINT count)
+{
+    while (count--)
+    {
+        *dst = (SHORT)le16(*(const SHORT *)src) / (float)0x8000;
+        src += istride;
+        dst += ostride;
+    }
+}
+
+static void get24_block(const BYTE *src, UINT istride, float *dst, UINT ostride, UINT count)
+{
+    while (count--)
+    {
+        LONG sample = (src[0] << 8) | (src[1] << 16) | (src[2] << 24);
+        *dst = sample / (float)0x80000000U;
+        src += istride;
+        dst += ostride;
+    }
+}
+
+static void get32_block(const BYTE *src, UINT istride, float *dst, UINT ostride, UINT count)
+{
+    while (count--)
+    {
+        *dst = (LONG)le32(*(const LONG *)src) / (float)0x80000000U;
+        src += istride;
+        dst += ostride;
+    }
+}
+
+static void getieee32_block(const BYTE *src, UINT istride, float *dst, UINT ostride, UINT count)
+{
+    while (count--)
+    {
+        *dst = *(const float *)src;
+        src += istride;
+        dst += ostride;
+    }
+}
+
+const bitsgetblockfunc getblockbpp[5] = {get8_block, get16_block, get24_block, get32_block, getieee32_block};
+
 float get_mono(const IDirectSoundBufferImpl *dsb, DWORD pos, DWORD channel)
 {
     DWORD channels = dsb->pwfx->nChannels;
@@ -325,10 +380,52 @@ void put_quad2stereo(const IDirectSoundBufferImpl *dsb, DWORD pos, DWORD channel
 void mixieee32(float *src, float *dst, unsigned samples)
 {
     TRACE("%p - %p %d\n", src, dst, samples);
+    for (; samples >= 4; samples -= 4, src += 4, dst += 4)
+    {
+        dst[0] += src[0];
+        dst[1] += src[1];
+        dst[2] += src[2];
+        dst[3] += src[3];
+    }
     while (samples--)
         *(dst++) += *(src++);
 }
 
+/* mix src into dst, scaling each channel by its volume */
+void mixieee32_vol(const float *src, float *dst, unsigned frames, unsigned channels, const float *vols)
+{
+    unsigned chan;
+
+    TRACE("%p - %p %u %u\n", src, dst, frames, channels);
+
+    if (channels == 2)
+    {
+        const float left = vols[0], right = vols[1];
+
+        for (; frames >= 2; frames -= 2, src += 4, dst += 4)
+        {
+            dst[0] += src[0] * left;
+            dst[1] += src[1] * right;
+            dst[2] += src[2] * left;
+            dst[3] += src[3] * right;
+        }
+        if (frames)
+        {
+            dst[0] += src[0] * left;
+            dst[1] += src[1] * right;
+        }
+        return;
+    }
+
+    while (frames--)
+    {
+        for (chan = 0; chan < channels; chan++)
+            dst[chan] += src[chan] * vols[chan];
+        src += channels;
+        dst += channels;
+    }
+}
+
 static void norm8(float *src, unsigned char *dst, unsigned samples)
 {
     TRACE("%p - %p %d\n", src, dst, samples);
@@ -92,6 +92,7 @@ const WCHAR wine_vxd_drv[] = { 'w','i','n','e','m','m','.','v','x','d', 0 };
 
 /* All default settings, you most likely don't want to touch these, see wiki on UsefulRegistryKeys */
 int ds_hel_buflen = 32768 * 2;
+int ds_resample_quality = DS_RESAMPLE_FIR;
 static HINSTANCE instance;
 
 /*
@@ -144,10 +145,23 @@ void setup_dsound_options(void)
     if (!get_config_key( hkey, appkey, "HelBuflen", buffer, MAX_PATH ))
         ds_hel_buflen = atoi(buffer);
 
+    if (!get_config_key( hkey, appkey, "ResampleQuality", buffer, MAX_PATH ))
+    {
+        if (!lstrcmpiA( buffer, "linear" ))
+            ds_resample_quality = DS_RESAMPLE_LINEAR;
+        else if (!lstrcmpiA( buffer, "cubic" ))
+            ds_resample_quality = DS_RESAMPLE_CUBIC;
+        else if (!lstrcmpiA( buffer, "fir" ))
+            ds_resample_quality = DS_RESAMPLE_FIR;
+        else
+            WARN("unknown ResampleQuality %s\n", debugstr_a(buffer));
+    }
+
     if (appkey) RegCloseKey( appkey );
     if (hkey) RegCloseKey( hkey );
 
     TRACE("ds_hel_buflen = %d\n", ds_hel_buflen);
+    TRACE("ds_resample_quality = %d\n", ds_resample_quality);
 }
 
 static const char * get_device_id(LPCGUID pGuid)
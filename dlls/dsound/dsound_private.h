@@ -35,6 +35,12 @@
 #define DS_MAX_CHANNELS 6
 
 extern int ds_hel_buflen DECLSPEC_HIDDEN;
+extern int ds_resample_quality DECLSPEC_HIDDEN;
+
+/* values for ds_resample_quality */
+#define DS_RESAMPLE_LINEAR 0
+#define DS_RESAMPLE_CUBIC  1
+#define DS_RESAMPLE_FIR    2
 
 /*****************************************************************************
  * Predeclare the interface implementation structures
@@ -45,10 +51,13 @@ typedef struct DirectSoundDevice             DirectSoundDevice;
 /* dsound_convert.h */
 typedef float (*bitsgetfunc)(const IDirectSoundBufferImpl *, DWORD, DWORD);
 typedef void (*bitsputfunc)(const IDirectSoundBufferImpl *, DWORD, DWORD, float);
+typedef void (*bitsgetblockfunc)(const BYTE *, UINT, float *, UINT, UINT);
 extern const bitsgetfunc getbpp[5] DECLSPEC_HIDDEN;
+extern const bitsgetblockfunc getblockbpp[5] DECLSPEC_HIDDEN;
 void putieee32(const IDirectSoundBufferImpl *dsb, DWORD pos, DWORD channel, float value) DECLSPEC_HIDDEN;
 void putieee32_sum(const IDirectSoundBufferImpl *dsb, DWORD pos, DWORD channel, float value) DECLSPEC_HIDDEN;
 void mixieee32(float *src, float *dst, unsigned samples) DECLSPEC_HIDDEN;
+void mixieee32_vol(const float *src, float *dst, unsigned frames, unsigned channels, const float *vols) DECLSPEC_HIDDEN;
 typedef void (*normfunc)(const void *, void *, unsigned);
 extern const normfunc normfunctions[4] DECLSPEC_HIDDEN;
 
@@ -151,6 +160,8 @@ struct IDirectSoundBufferImpl
     float                       firgain;
     LONG64                      freqAdjustNum,freqAdjustDen;
     LONG64                      freqAccNum;
+    float                      *fir_phases;      /* FIR for each resampling phase */
+    DWORD                       fir_phases_step; /* 0 if not computed yet, ~0u if not used */
     /* used for mixing */
     DWORD                       sec_mixpos;
 
@@ -165,6 +176,7 @@ struct IDirectSoundBufferImpl
     int                         mix_channels;
     bitsgetfunc get, get_aux;
     bitsputfunc put, put_aux;
+    bitsgetblockfunc get_block;  /* NULL unless channels are copied as they are */
     int                         num_filters;
     DSFilter*                   filters;
 
@@ -132,6 +132,10 @@ void DSOUND_RecalcFormat(IDirectSoundBufferImpl *dsb)
 
 	dsb->freqAccNum = 0;
 
+	HeapFree(GetProcessHeap(), 0, dsb->fir_phases);
+	dsb->fir_phases = NULL;
+	dsb->fir_phases_step = 0;
+
 	dsb->get_aux = ieee ? getbpp[4] : getbpp[dsb->pwfx->wBitsPerSample/8 - 1];
 	dsb->put_aux = putieee32;
 
@@ -196,6 +200,11 @@ void DSOUND_RecalcFormat(IDirectSoundBufferImpl *dsb)
 			FIXME("Conversion from %u to %u channels is not implemented, falling back to stereo\n", ichannels, ochannels);
 		dsb->mix_channels = 2;
 	}
+
+	if (dsb->get == dsb->get_aux)
+		dsb->get_block = ieee ? getblockbpp[4] : getblockbpp[dsb->pwfx->wBitsPerSample/8 - 1];
+	else
+		dsb->get_block = NULL;
 }
 
 /**
@@ -283,11 +292,53 @@ static inline float get_current_sample(const IDirectSoundBufferImpl *dsb,
     return dsb->get(dsb, mixpos % dsb->buflen, channel);
 }
 
+/* Same as calling get_current_sample() for count frames starting at mixpos,
+ * but converting whole runs of samples at a time. */
+static void get_current_samples(const IDirectSoundBufferImpl *dsb,
+        DWORD mixpos, DWORD channel, float *dst, UINT ostride, UINT count)
+{
+    UINT istride = dsb->pwfx->nBlockAlign;
+    UINT offset = channel * (dsb->pwfx->wBitsPerSample / 8);
+    UINT run;
+
+    while (count)
+    {
+        if (mixpos >= dsb->buflen)
+        {
+            if (!(dsb->playflags & DSBPLAY_LOOPING))
+            {
+                while (count--)
+                {
+                    *dst = 0.0f;
+                    dst += ostride;
+                }
+                return;
+            }
+            mixpos %= dsb->buflen;
+        }
+
+        run = min(count, (dsb->buflen - mixpos + istride - 1) / istride);
+        dsb->get_block(dsb->buffer->memory + mixpos + offset, istride, dst, ostride, run);
+        dst += run * ostride;
+        mixpos += run * istride;
+        count -= run;
+    }
+}
+
 static UINT cp_fields_noresample(IDirectSoundBufferImpl *dsb, UINT count)
 {
     UINT istride = dsb->pwfx->nBlockAlign;
     UINT ostride = dsb->device->pwfx->nChannels * sizeof(float);
     DWORD channel, i;
+
+    if (dsb->get_block && dsb->put == putieee32)
+    {
+        for (channel = 0; channel < dsb->mix_channels; channel++)
+            get_current_samples(dsb, dsb->sec_mixpos, channel, dsb->device->tmp_buffer + channel,
+                    dsb->device->pwfx->nChannels, count);
+        return count;
+    }
+
     for (i = 0; i < count; i++)
         for (channel = 0; channel < dsb->mix_channels; channel++)
             dsb->put(dsb, i * ostride, channel, get_current_sample(dsb,
@@ -295,10 +346,112 @@ static UINT cp_fields_noresample(IDirectSoundBufferImpl *dsb, UINT count)
     return count;
 }
 
+static float *get_cp_buffer(DirectSoundDevice *device, DWORD len)
+{
+    if (!device->cp_buffer) {
+        device->cp_buffer = HeapAlloc(GetProcessHeap(), 0, len);
+        device->cp_buffer_len = len;
+    } else if (len > device->cp_buffer_len) {
+        device->cp_buffer = HeapReAlloc(GetProcessHeap(), 0, device->cp_buffer, len);
+        device->cp_buffer_len = len;
+    }
+    return device->cp_buffer;
+}
+
+/* Important: this buffer MUST be non-interleaved
+ * if you want -msse3 to have any effect.
+ * This is good for CPU cache effects, too.
+ */
+static void get_intermediate(const IDirectSoundBufferImpl *dsb, float *intermediate, UINT required_input)
+{
+    UINT istride = dsb->pwfx->nBlockAlign;
+    UINT channel, i;
+
+    if (dsb->get_block)
+    {
+        for (channel = 0; channel < dsb->mix_channels; channel++, intermediate += required_input)
+            get_current_samples(dsb, dsb->sec_mixpos, channel, intermediate, 1, required_input);
+    }
+    else
+    {
+        for (channel = 0; channel < dsb->mix_channels; channel++)
+            for (i = 0; i < required_input; i++)
+                *(intermediate++) = get_current_sample(dsb,
+                        dsb->sec_mixpos + i * istride, channel);
+    }
+}
+
+/* Maximum size of the table of precomputed FIR phases, in floats. Ratios
+ * needing more phases than this (odd frequencies set by the application)
+ * compute the FIR for each sample instead. */
+#define MAX_FIR_PHASES_SIZE 65536
+
+/**
+ * The FIR applied for an output sample depends only on the position of that
+ * sample between two input samples, which for a fixed frequency ratio can only
+ * take freqAdjustDen / gcd(freqAdjustNum, freqAdjustDen) different values.
+ * Compute the FIR for each of them once, scaled by firgain and padded with
+ * zeroes to fir_cachesize taps.
+ */
+static const float *get_fir_phases(IDirectSoundBufferImpl *dsb, UINT fir_cachesize)
+{
+    LONG64 a = dsb->freqAdjustNum, b = dsb->freqAdjustDen, t;
+    UINT phases, phase, idx, j;
+    float *coeffs;
+
+    if (dsb->fir_phases || dsb->fir_phases_step == ~0u)
+        return dsb->fir_phases;
+
+    while (b) {
+        t = a % b;
+        a = b;
+        b = t;
+    }
+    phases = dsb->freqAdjustDen / a;
+
+    if ((ULONG64)phases * fir_cachesize > MAX_FIR_PHASES_SIZE ||
+        !(dsb->fir_phases = HeapAlloc(GetProcessHeap(), 0, phases * fir_cachesize * sizeof(float)))) {
+        dsb->fir_phases_step = ~0u;
+        return NULL;
+    }
+    dsb->fir_phases_step = a;
+
+    for (phase = 0; phase < phases; phase++) {
+        LONG64 steps = (LONG64)phase * dsb->fir_phases_step * dsb->firstep;
+        float rem = 1.0f - (float)(steps % dsb->freqAdjustDen) / dsb->freqAdjustDen;
+
+        coeffs = dsb->fir_phases + phase * fir_cachesize;
+        idx = dsb->firstep - 1 - steps / dsb->freqAdjustDen;
+        for (j = 0; j < fir_cachesize; j++, idx += dsb->firstep) {
+            if (idx < fir_len - 1)
+                coeffs[j] = (fir[idx] * (1.0f - rem) + fir[idx + 1] * rem) * dsb->firgain;
+            else
+                coeffs[j] = 0.0f;
+        }
+    }
+
+    return dsb->fir_phases;
+}
+
+static inline float fir_dot(const float *coeffs, const float *samples, UINT len)
+{
+    float sum0 = 0.0f, sum1 = 0.0f, sum2 = 0.0f, sum3 = 0.0f;
+    UINT j;
+
+    for (j = 0; j + 4 <= len; j += 4) {
+        sum0 += coeffs[j] * samples[j];
+        sum1 += coeffs[j + 1] * samples[j + 1];
+        sum2 += coeffs[j + 2] * samples[j + 2];
+        sum3 += coeffs[j + 3] * samples[j + 3];
+    }
+    for (; j < len; j++)
+        sum0 += coeffs[j] * samples[j];
+    return (sum0 + sum1) + (sum2 + sum3);
+}
+
 static UINT cp_fields_resample(IDirectSoundBufferImpl *dsb, UINT count, LONG64 *freqAccNum)
 {
     UINT i, channel;
-    UINT istride = dsb->pwfx->nBlockAlign;
     UINT ostride = dsb->device->pwfx->nChannels * sizeof(float);
 
     LONG64 freqAcc_start = *freqAccNum;
@@ -309,33 +462,33 @@ static UINT cp_fields_resample(IDirectSoundBufferImpl *dsb, UINT count, LONG64 *
 
     UINT fir_cachesize = (fir_len + dsbfirstep - 2) / dsbfirstep;
     UINT required_input = max_ipos + fir_cachesize;
-    float *intermediate, *fir_copy, *itmp;
+    float *intermediate, *fir_copy;
+    const float *phases;
 
     DWORD len = required_input * channels;
     len += fir_cachesize;
     len *= sizeof(float);
 
-    if (!dsb->device->cp_buffer) {
-        dsb->device->cp_buffer = HeapAlloc(GetProcessHeap(), 0, len);
-        dsb->device->cp_buffer_len = len;
-    } else if (len > dsb->device->cp_buffer_len) {
-        dsb->device->cp_buffer = HeapReAlloc(GetProcessHeap(), 0, dsb->device->cp_buffer, len);
-        dsb->device->cp_buffer_len = len;
-    }
-
-    fir_copy = dsb->device->cp_buffer;
+    fir_copy = get_cp_buffer(dsb->device, len);
     intermediate = fir_copy + fir_cachesize;
 
+    get_intermediate(dsb, intermediate, required_input);
 
-    /* Important: this buffer MUST be non-interleaved
-     * if you want -msse3 to have any effect.
-     * This is good for CPU cache effects, too.
-     */
-    itmp = intermediate;
-    for (channel = 0; channel < channels; channel++)
-        for (i = 0; i < required_input; i++)
-            *(itmp++) = get_current_sample(dsb,
-                    dsb->sec_mixpos + i * istride, channel);
+    phases = get_fir_phases(dsb, fir_cachesize);
+    if (phases && !(freqAcc_start % dsb->fir_phases_step)) {
+        for (i = 0; i < count; ++i) {
+            LONG64 pos = freqAcc_start + i * dsb->freqAdjustNum;
+            UINT ipos = pos / dsb->freqAdjustDen;
+            const float *coeffs = phases + (pos % dsb->freqAdjustDen) / dsb->fir_phases_step * fir_cachesize;
+
+            for (channel = 0; channel < channels; channel++)
+                dsb->put(dsb, i * ostride, channel,
+                        fir_dot(coeffs, &intermediate[channel * required_input + ipos], fir_cachesize));
+        }
+
+        *freqAccNum = freqAcc_end % dsb->freqAdjustDen;
+        return max_ipos;
+    }
 
     for(i = 0; i < count; ++i) {
         UINT int_fir_steps = (freqAcc_start + i * dsb->freqAdjustNum) * dsbfirstep / dsb->freqAdjustDen;
@@ -369,12 +522,56 @@ static UINT cp_fields_resample(IDirectSoundBufferImpl *dsb, UINT count, LONG64 *
     return max_ipos;
 }
 
+/* Cheaper resampling by linear or cubic (Catmull-Rom) interpolation, without
+ * any filtering. Cubic interpolation is done between the second and third of
+ * four input samples, so it lags one sample behind. */
+static UINT cp_fields_resample_interp(IDirectSoundBufferImpl *dsb, UINT count, LONG64 *freqAccNum, BOOL cubic)
+{
+    UINT i, channel;
+    UINT ostride = dsb->device->pwfx->nChannels * sizeof(float);
+
+    LONG64 freqAcc_start = *freqAccNum;
+    LONG64 freqAcc_end = freqAcc_start + count * dsb->freqAdjustNum;
+    UINT channels = dsb->mix_channels;
+    UINT max_ipos = freqAcc_end / dsb->freqAdjustDen;
+    UINT required_input = max_ipos + (cubic ? 4 : 2);
+    float *intermediate = get_cp_buffer(dsb->device, required_input * channels * sizeof(float));
+
+    get_intermediate(dsb, intermediate, required_input);
+
+    for (i = 0; i < count; ++i) {
+        LONG64 pos = freqAcc_start + i * dsb->freqAdjustNum;
+        UINT ipos = pos / dsb->freqAdjustDen;
+        float t = (pos % dsb->freqAdjustDen) / (float)dsb->freqAdjustDen;
+
+        for (channel = 0; channel < channels; channel++) {
+            const float *x = &intermediate[channel * required_input + ipos];
+            float value;
+
+            if (cubic)
+                value = x[1] + 0.5f * t * (x[2] - x[0] + t * (2.0f * x[0] - 5.0f * x[1] + 4.0f * x[2] - x[3] +
+                        t * (3.0f * (x[1] - x[2]) + x[3] - x[0])));
+            else
+                value = x[0] + (x[1] - x[0]) * t;
+            dsb->put(dsb, i * ostride, channel, value);
+        }
+    }
+
+    *freqAccNum = freqAcc_end % dsb->freqAdjustDen;
+
+    return max_ipos;
+}
+
 static void cp_fields(IDirectSoundBufferImpl *dsb, UINT count, LONG64 *freqAccNum)
 {
     DWORD ipos, adv;
 
     if (dsb->freqAdjustNum == dsb->freqAdjustDen)
         adv = cp_fields_noresample(dsb, count); /* *freqAccNum is unmodified */
+    else if (ds_resample_quality == DS_RESAMPLE_LINEAR)
+        adv = cp_fields_resample_interp(dsb, count, freqAccNum, FALSE);
+    else if (ds_resample_quality == DS_RESAMPLE_CUBIC)
+        adv = cp_fields_resample_interp(dsb, count, freqAccNum, TRUE);
     else
         adv = cp_fields_resample(dsb, count, freqAccNum);
 
@@ -451,11 +648,12 @@ static void DSOUND_MixToTemporary(IDirectSoundBufferImpl *dsb, DWORD frames)
 	}
 }
 
-static void DSOUND_MixerVol(const IDirectSoundBufferImpl *dsb, INT frames)
+/* Apply volume if needed, and mix the temporary buffer into mix_buffer */
+static void DSOUND_MixerVol(const IDirectSoundBufferImpl *dsb, float *mix_buffer, INT frames)
 {
 	INT	i;
 	float vols[DS_MAX_CHANNELS];
-	UINT channels = dsb->device->pwfx->nChannels, chan;
+	UINT channels = dsb->device->pwfx->nChannels;
 
 	TRACE("(%p,%d)\n",dsb,frames);
 	TRACE("left = %x, right = %x\n", dsb->volpan.dwTotalAmpFactor[0],
@@ -464,22 +662,23 @@ static void DSOUND_MixerVol(const IDirectSoundBufferImpl *dsb, INT frames)
 	if ((!(dsb->dsbd.dwFlags & DSBCAPS_CTRLPAN) || (dsb->volpan.lPan == 0)) &&
 	    (!(dsb->dsbd.dwFlags & DSBCAPS_CTRLVOLUME) || (dsb->volpan.lVolume == 0)) &&
 	     !(dsb->dsbd.dwFlags & DSBCAPS_CTRL3D))
-		return; /* Nothing to do */
+	{
+		/* No volume to apply */
+		mixieee32(dsb->device->tmp_buffer, mix_buffer, frames * channels);
+		return;
+	}
 
 	if (channels > DS_MAX_CHANNELS)
 	{
 		FIXME("There is no support for %u channels\n", channels);
+		mixieee32(dsb->device->tmp_buffer, mix_buffer, frames * channels);
 		return;
 	}
 
 	for (i = 0; i < channels; ++i)
 		vols[i] = dsb->volpan.dwTotalAmpFactor[i] / ((float)0xFFFF);
 
-	for(i = 0; i < frames; ++i){
-		for(chan = 0; chan < channels; ++chan){
-			dsb->device->tmp_buffer[i * channels + chan] *= vols[chan];
-		}
-	}
+	mixieee32_vol(dsb->device->tmp_buffer, mix_buffer, frames, channels, vols);
 }
 
 /**
@@ -496,7 +695,6 @@ static void DSOUND_MixerVol(const IDirectSoundBufferImpl *dsb, INT frames)
  */
 static DWORD DSOUND_MixInBuffer(IDirectSoundBufferImpl *dsb, float *mix_buffer, DWORD frames)
 {
-	float *ibuf;
 	DWORD oldpos;
 
 	TRACE("sec_mixpos=%d/%d\n", dsb->sec_mixpos, dsb->buflen);
@@ -505,12 +703,9 @@ static DWORD DSOUND_MixInBuffer(IDirectSoundBufferImpl *dsb, float *mix_buffer,
 	/* Resample buffer to temporary buffer specifically allocated for this purpose, if needed */
 	oldpos = dsb->sec_mixpos;
 	DSOUND_MixToTemporary(dsb, frames);
-	ibuf = dsb->device->tmp_buffer;
-
-	/* Apply volume if needed */
-	DSOUND_MixerVol(dsb, frames);
 
-	mixieee32(ibuf, mix_buffer, frames * dsb->device->pwfx->nChannels);
+	/* Apply volume if needed, and mix into the device buffer */
+	DSOUND_MixerVol(dsb, mix_buffer, frames);
 
 	/* check for notification positions */
 	if (dsb->dsbd.dwFlags & DSBCAPS_CTRLPOSITIONNOTIFY &&
@@ -1058,6 +1058,100 @@ EXIT:
     return rc;
 }
 
+/* The mixed output can't be read back, but a buffer that isn't resampled
+ * at the right rate doesn't finish playing in the expected time either. */
+static void test_resampled_playback(LPGUID lpGuid)
+{
+    static const struct
+    {
+        DWORD rate;      /* the rate of the buffer data */
+        DWORD frequency; /* the playback frequency, 0 to keep the rate */
+    }
+    tests[] =
+    {
+        { 8000 },
+        { 22050 },
+        { 44100 },
+        { 96000 },
+        { 22050, 44100 },
+        { 44100, 11025 },
+    };
+    LPDIRECTSOUNDBUFFER secondary;
+    LPDIRECTSOUND dso = NULL;
+    DWORD size, status, start, elapsed, expected, i;
+    DSBUFFERDESC bufdesc;
+    WAVEFORMATEX wfx;
+    void *ptr, *data;
+    HRESULT rc;
+    int ref;
+
+    rc = pDirectSoundCreate(lpGuid, &dso, NULL);
+    ok(rc == DS_OK || rc == DSERR_NODRIVER || rc == DSERR_ALLOCATED,
+       "DirectSoundCreate() failed: %08x\n", rc);
+    if (rc != DS_OK)
+        return;
+
+    rc = IDirectSound_SetCooperativeLevel(dso, get_hwnd(), DSSCL_PRIORITY);
+    ok(rc == DS_OK, "IDirectSound_SetCooperativeLevel() failed: %08x\n", rc);
+
+    for (i = 0; i < ARRAY_SIZE(tests); i++)
+    {
+        init_format(&wfx, WAVE_FORMAT_PCM, tests[i].rate, 16, 2);
+        data = wave_generate_la(&wfx, 0.3, &size, FALSE);
+
+        ZeroMemory(&bufdesc, sizeof(bufdesc));
+        bufdesc.dwSize = sizeof(bufdesc);
+        bufdesc.dwFlags = DSBCAPS_GETCURRENTPOSITION2 | DSBCAPS_CTRLFREQUENCY;
+        bufdesc.dwBufferBytes = size;
+        bufdesc.lpwfxFormat = &wfx;
+        secondary = NULL;
+        rc = IDirectSound_CreateSoundBuffer(dso, &bufdesc, &secondary, NULL);
+        ok(rc == DS_OK && secondary != NULL, "%u: CreateSoundBuffer() failed: %08x\n", i, rc);
+        if (rc != DS_OK)
+        {
+            HeapFree(GetProcessHeap(), 0, data);
+            continue;
+        }
+
+        rc = IDirectSoundBuffer_Lock(secondary, 0, size, &ptr, &size, NULL, NULL, 0);
+        ok(rc == DS_OK, "%u: Lock() failed: %08x\n", i, rc);
+        memcpy(ptr, data, size);
+        IDirectSoundBuffer_Unlock(secondary, ptr, size, NULL, 0);
+        HeapFree(GetProcessHeap(), 0, data);
+
+        expected = 300;
+        if (tests[i].frequency)
+        {
+            rc = IDirectSoundBuffer_SetFrequency(secondary, tests[i].frequency);
+            ok(rc == DS_OK, "%u: SetFrequency() failed: %08x\n", i, rc);
+            expected = MulDiv(expected, tests[i].rate, tests[i].frequency);
+        }
+
+        start = GetTickCount();
+        rc = IDirectSoundBuffer_Play(secondary, 0, 0, 0);
+        ok(rc == DS_OK, "%u: Play() failed: %08x\n", i, rc);
+        do
+        {
+            Sleep(5);
+            rc = IDirectSoundBuffer_GetStatus(secondary, &status);
+            elapsed = GetTickCount() - start;
+        } while (rc == DS_OK && (status & DSBSTATUS_PLAYING) && elapsed < 4 * expected + 1000);
+        ok(rc == DS_OK, "%u: GetStatus() failed: %08x\n", i, rc);
+
+        ok(!(status & DSBSTATUS_PLAYING), "%u: buffer still playing after %u ms\n", i, elapsed);
+        /* Allow for the mixing period and device latency. */
+        ok(elapsed >= expected * 3 / 4 && elapsed <= expected * 3 / 2 + 200,
+           "%u: %u Hz buffer played at %u Hz took %u ms, expected %u ms\n", i, tests[i].rate,
+           tests[i].frequency ? tests[i].frequency : tests[i].rate, elapsed, expected);
+
+        ref = IDirectSoundBuffer_Release(secondary);
+        ok(ref == 0, "%u: IDirectSoundBuffer_Release() has %d references\n", i, ref);
+    }
+
+    ref = IDirectSound_Release(dso);
+    ok(ref == 0, "IDirectSound_Release() has %d references, should have 0\n", ref);
+}
+
 static HRESULT test_notify(LPDIRECTSOUNDBUFFER dsb,
                            DWORD count, LPHANDLE event,
                            DWORD expected)
@@ -1665,6 +1759,7 @@ static BOOL WINAPI dsenum_callback(LPGUID lpGuid, LPCSTR lpcstrDescription,
         test_primary_secondary(lpGuid);
         test_secondary(lpGuid);
         test_frequency(lpGuid);
+        test_resampled_playback(lpGuid);
         test_duplicate(lpGuid);
         test_invalid_fmts(lpGuid);
         test_notifications(lpGuid);
@@ -405,7 +405,7 @@ static UINT copy_file( MSIPACKAGE *package, MSIFILE *file, WCHAR *source )
     return ERROR_SUCCESS;
 }
 
-static UINT copy_install_file(MSIPACKAGE *package, MSIFILE *file, LPWSTR source)
+static UINT copy_install_file(MSIPACKAGE *package, MSIFILE *file, LPWSTR source, BOOL *need_reboot)
 {
     UINT gle;
 
@@ -449,7 +449,7 @@ static UINT copy_install_file(MSIPACKAGE *package, MSIFILE *file, LPWSTR source)
             msi_move_file( package, file->TargetPath, NULL, MOVEFILE_DELAY_UNTIL_REBOOT ) &&
             msi_move_file( package, tmpfileW, file->TargetPath, MOVEFILE_DELAY_UNTIL_REBOOT ))
         {
-            package->need_reboot_at_end = 1;
+            *need_reboot = TRUE;
             gle = ERROR_SUCCESS;
         }
         else
@@ -464,6 +464,224 @@ static UINT copy_install_file(MSIPACKAGE *package, MSIFILE *file, LPWSTR source)
     return gle;
 }
 
+/* Uncompressed files can be copied by a bounded pool of worker threads, if
+ * enabled with the InstallFilesThreads value. Everything that touches shared
+ * package state (UI messages, media prompts, folder creation, file states)
+ * stays on the calling thread; the workers only copy data. */
+#define COPY_QUEUE_BATCH_SIZE 64
+
+struct copy_job
+{
+    struct list        entry;
+    struct copy_queue *queue;
+    MSIPACKAGE        *package;
+    MSIFILE           *file;
+    WCHAR             *source;
+    UINT               error;
+    BOOL               need_reboot;
+};
+
+struct copy_queue
+{
+    CRITICAL_SECTION cs;
+    HANDLE           slots; /* semaphore limiting the number of copies in flight */
+    HANDLE           idle;  /* signaled when no copy is in flight */
+    UINT             pending;
+    BOOL             failed;
+    UINT             count;
+    UINT             disk_id;
+    struct list      jobs;
+};
+
+static UINT get_copy_thread_count( MSIPACKAGE *package )
+{
+    static const WCHAR msikeyW[] = {'S','o','f','t','w','a','r','e','\\','W','i','n','e','\\','M','s','i',0};
+    static const WCHAR threadsW[] = {'I','n','s','t','a','l','l','F','i','l','e','s','T','h','r','e','a','d','s',0};
+    DWORD count, type, size = sizeof(count);
+    HKEY hkey;
+
+    /* the wow64 redirection cookie is stored in the package */
+    if (is_wow64 && package->platform == PLATFORM_X64) return 1;
+
+    if (!RegOpenKeyExW( HKEY_CURRENT_USER, msikeyW, 0, KEY_QUERY_VALUE, &hkey ))
+    {
+        LONG res = RegQueryValueExW( hkey, threadsW, NULL, &type, (BYTE *)&count, &size );
+        RegCloseKey( hkey );
+        if (!res && type == REG_DWORD) return count;
+    }
+    return 1;
+}
+
+static struct copy_queue *create_copy_queue( MSIPACKAGE *package )
+{
+    struct copy_queue *queue;
+    UINT threads = get_copy_thread_count( package );
+
+    TRACE("using %u thread(s) to copy files\n", threads);
+    if (threads < 2 || !(queue = msi_alloc_zero( sizeof(*queue) ))) return NULL;
+
+    if (!(queue->slots = CreateSemaphoreW( NULL, threads, threads, NULL )))
+    {
+        msi_free( queue );
+        return NULL;
+    }
+    if (!(queue->idle = CreateEventW( NULL, TRUE, TRUE, NULL )))
+    {
+        CloseHandle( queue->slots );
+        msi_free( queue );
+        return NULL;
+    }
+    InitializeCriticalSection( &queue->cs );
+    queue->cs.DebugInfo->Spare[0] = (DWORD_PTR)(__FILE__ ": copy_queue.cs");
+    list_init( &queue->jobs );
+    return queue;
+}
+
+static void run_copy_job( struct copy_job *job )
+{
+    struct copy_queue *queue = job->queue;
+    BOOL failed;
+
+    EnterCriticalSection( &queue->cs );
+    failed = queue->failed;
+    LeaveCriticalSection( &queue->cs );
+
+    /* don't start copying once another copy has failed */
+    if (failed) job->error = ERROR_CANCELLED;
+    else job->error = copy_install_file( job->package, job->file, job->source, &job->need_reboot );
+
+    EnterCriticalSection( &queue->cs );
+    if (job->error != ERROR_SUCCESS) queue->failed = TRUE;
+    if (!--queue->pending) SetEvent( queue->idle );
+    LeaveCriticalSection( &queue->cs );
+    ReleaseSemaphore( queue->slots, 1, NULL );
+}
+
+static void CALLBACK copy_job_callback( TP_CALLBACK_INSTANCE *instance, void *context )
+{
+    run_copy_job( context );
+}
+
+/* wait for all queued copies, then report progress and update the state
+ * of the copied files in the order they were queued */
+static UINT finish_copy_queue( MSIPACKAGE *package, struct copy_queue *queue )
+{
+    struct copy_job *job, *next;
+    UINT rc = ERROR_SUCCESS;
+
+    WaitForSingleObject( queue->idle, INFINITE );
+
+    LIST_FOR_EACH_ENTRY_SAFE( job, next, &queue->jobs, struct copy_job, entry )
+    {
+        if (job->error != ERROR_SUCCESS && job->error != ERROR_CANCELLED)
+        {
+            ERR("Failed to copy %s to %s (%u)\n", debugstr_w(job->source),
+                debugstr_w(job->file->TargetPath), job->error);
+        }
+        if (rc == ERROR_SUCCESS)
+        {
+            if (job->error != ERROR_SUCCESS) rc = ERROR_INSTALL_FAILURE;
+            else
+            {
+                msi_file_update_ui( package, job->file, szInstallFiles );
+                if (job->need_reboot) package->need_reboot_at_end = 1;
+                if (!msi_is_global_assembly( job->file->Component )) job->file->state = msifs_installed;
+            }
+        }
+        list_remove( &job->entry );
+        msi_free( job->source );
+        msi_free( job );
+    }
+    queue->count = 0;
+    queue->failed = FALSE;
+    return rc;
+}
+
+static void destroy_copy_queue( MSIPACKAGE *package, struct copy_queue *queue )
+{
+    if (!queue) return;
+    finish_copy_queue( package, queue );
+    CloseHandle( queue->slots );
+    CloseHandle( queue->idle );
+    queue->cs.DebugInfo->Spare[0] = 0;
+    DeleteCriticalSection( &queue->cs );
+    msi_free( queue );
+}
+
+static BOOL is_copy_queued( struct copy_queue *queue, const WCHAR *path )
+{
+    struct copy_job *job;
+
+    LIST_FOR_EACH_ENTRY( job, &queue->jobs, struct copy_job, entry )
+    {
+        if (!wcsicmp( job->file->TargetPath, path )) return TRUE;
+    }
+    return FALSE;
+}
+
+/* takes ownership of source */
+static UINT queue_copy_file( MSIPACKAGE *package, struct copy_queue *queue, MSIFILE *file, WCHAR *source )
+{
+    struct copy_job *job;
+    BOOL failed;
+    UINT rc;
+
+    EnterCriticalSection( &queue->cs );
+    failed = queue->failed;
+    LeaveCriticalSection( &queue->cs );
+
+    /* a failed copy ends the install, so don't queue anything after it */
+    if (failed || queue->count >= COPY_QUEUE_BATCH_SIZE || is_copy_queued( queue, file->TargetPath ))
+    {
+        if ((rc = finish_copy_queue( package, queue )))
+        {
+            msi_free( source );
+            return rc;
+        }
+    }
+
+    if (!(job = msi_alloc_zero( sizeof(*job) )))
+    {
+        msi_free( source );
+        return ERROR_OUTOFMEMORY;
+    }
+    job->queue   = queue;
+    job->package = package;
+    job->file    = file;
+    job->source  = source;
+
+    WaitForSingleObject( queue->slots, INFINITE );
+
+    EnterCriticalSection( &queue->cs );
+    failed = queue->failed;
+    if (!failed && !queue->pending++) ResetEvent( queue->idle );
+    LeaveCriticalSection( &queue->cs );
+
+    list_add_tail( &queue->jobs, &job->entry );
+    queue->count++;
+
+    if (failed)
+    {
+        /* stop queueing as soon as a copy fails */
+        ReleaseSemaphore( queue->slots, 1, NULL );
+        job->error = ERROR_CANCELLED;
+        return finish_copy_queue( package, queue );
+    }
+
+    if (!TrySubmitThreadpoolCallback( copy_job_callback, job, NULL )) run_copy_job( job );
+    return ERROR_SUCCESS;
+}
+
+/* report a file that isn't queued, once the queued ones have been reported */
+static UINT update_ui_after_queue( MSIPACKAGE *package, struct copy_queue *queue, MSIFILE *file )
+{
+    UINT rc;
+
+    if (queue->count && (rc = finish_copy_queue( package, queue ))) return rc;
+    msi_file_update_ui( package, file, szInstallFiles );
+    return ERROR_SUCCESS;
+}
+
 static UINT create_directory( MSIPACKAGE *package, const WCHAR *dir )
 {
     MSIFOLDER *folder;
@@ -556,6 +774,7 @@ WCHAR *msi_resolve_file_source( MSIPACKAGE *package, MSIFILE *file )
 UINT ACTION_InstallFiles(MSIPACKAGE *package)
 {
     MSIMEDIAINFO *mi;
+    struct copy_queue *queue;
     UINT rc = ERROR_SUCCESS;
     MSIFILE *file;
 
@@ -566,12 +785,14 @@ UINT ACTION_InstallFiles(MSIPACKAGE *package)
 
     schedule_install_files(package);
     mi = msi_alloc_zero( sizeof(MSIMEDIAINFO) );
+    queue = create_copy_queue( package );
 
     LIST_FOR_EACH_ENTRY( file, &package->files, MSIFILE, entry )
     {
-        BOOL is_global_assembly = msi_is_global_assembly( file->Component );
+        BOOL is_global_assembly = msi_is_global_assembly( file->Component ), need_reboot = FALSE;
 
-        msi_file_update_ui( package, file, szInstallFiles );
+        /* with a copy queue, progress is reported once the file is done */
+        if (!queue) msi_file_update_ui( package, file, szInstallFiles );
 
         rc = msi_load_media_info( package, file->Sequence, mi );
         if (rc != ERROR_SUCCESS)
@@ -581,6 +802,10 @@ UINT ACTION_InstallFiles(MSIPACKAGE *package)
             goto done;
         }
 
+        /* files from the previous disk have to be copied before it can be swapped */
+        if (queue && queue->count && queue->disk_id != mi->disk_id &&
+            (rc = finish_copy_queue( package, queue ))) goto done;
+
         if (file->state != msifs_hashmatch &&
             file->state != msifs_skipped &&
             (file->state != msifs_present || !msi_get_property_int( package->db, szInstalled, 0 )) &&
@@ -591,7 +816,11 @@ UINT ACTION_InstallFiles(MSIPACKAGE *package)
         }
 
         if (file->state != msifs_missing && !mi->is_continuous && file->state != msifs_overwrite)
+        {
+            if (queue && (rc = update_ui_after_queue( package, queue, file ))) goto done;
             continue;
+        }
+        if (queue && file->IsCompressed && (rc = update_ui_after_queue( package, queue, file ))) goto done;
 
         if (file->Sequence > mi->last_sequence || mi->is_continuous ||
             (file->IsCompressed && !mi->is_extracted))
@@ -622,7 +851,14 @@ UINT ACTION_InstallFiles(MSIPACKAGE *package)
             {
                 create_directory(package, file->Component->Directory);
             }
-            rc = copy_install_file(package, file, source);
+            if (queue)
+            {
+                queue->disk_id = mi->disk_id;
+                if ((rc = queue_copy_file(package, queue, file, source))) goto done;
+                continue;
+            }
+            rc = copy_install_file(package, file, source, &need_reboot);
+            if (need_reboot) package->need_reboot_at_end = 1;
             if (rc != ERROR_SUCCESS)
             {
                 ERR("Failed to copy %s to %s (%u)\n", debugstr_w(source), debugstr_w(file->TargetPath), rc);
@@ -641,6 +877,8 @@ UINT ACTION_InstallFiles(MSIPACKAGE *package)
             goto done;
         }
     }
+    if (queue && (rc = finish_copy_queue( package, queue ))) goto done;
+
     LIST_FOR_EACH_ENTRY( file, &package->files, MSIFILE, entry )
     {
         MSICOMPONENT *comp = file->Component;
@@ -659,6 +897,7 @@ UINT ACTION_InstallFiles(MSIPACKAGE *package)
     }
 
 done:
+    destroy_copy_queue(package, queue);
     msi_free_media_info(mi);
     return rc;
 }
@@ -57,6 +57,7 @@ typedef struct tagMSICOLUMNINFO
     INT     ref_count;
     BOOL    temporary;
     MSICOLUMNHASHENTRY **hash_table;
+    UINT    hash_size;
 } MSICOLUMNINFO;
 
 struct tagMSITABLE
@@ -1048,6 +1049,79 @@ static UINT TABLE_fetch_int( struct tagMSIVIEW *view, UINT row, UINT col, UINT *
     return ERROR_SUCCESS;
 }
 
+static UINT TABLE_find_matching_rows( struct tagMSIVIEW *view, UINT col,
+    UINT val, UINT *row, MSIITERHANDLE *handle )
+{
+    MSITABLEVIEW *tv = (MSITABLEVIEW*)view;
+    const MSICOLUMNHASHENTRY *entry;
+
+    TRACE("(%p, %d, 0x%08x, %p)\n", view, col, val, handle);
+
+    if( !tv->table )
+        return ERROR_INVALID_PARAMETER;
+
+    if( (col==0) || (col > tv->num_cols) )
+        return ERROR_INVALID_PARAMETER;
+
+    if( !tv->columns[col-1].hash_table )
+    {
+        UINT i;
+        UINT num_rows = tv->table->row_count;
+        UINT hash_size = max( num_rows, MSITABLE_HASH_TABLE_SIZE );
+        MSICOLUMNHASHENTRY **hash_table;
+        MSICOLUMNHASHENTRY *new_entry;
+
+        if( tv->columns[col-1].offset >= tv->row_size )
+        {
+            ERR("Stuffed up %d >= %d\n", tv->columns[col-1].offset, tv->row_size );
+            ERR("%p %p\n", tv, tv->columns );
+            return ERROR_FUNCTION_FAILED;
+        }
+
+        /* allocate contiguous memory for the table and its entries so we
+         * don't have to do an expensive cleanup */
+        hash_table = msi_alloc_zero( hash_size * sizeof(MSICOLUMNHASHENTRY*) +
+                                     num_rows * sizeof(MSICOLUMNHASHENTRY) );
+        if (!hash_table)
+            return ERROR_OUTOFMEMORY;
+
+        new_entry = (MSICOLUMNHASHENTRY *)(hash_table + hash_size);
+
+        /* insert backwards, so that each chain is ordered by row number */
+        for (i = num_rows; i > 0; i--)
+        {
+            UINT row_value;
+
+            if (TABLE_fetch_int( view, i - 1, col, &row_value ))
+                continue;
+
+            new_entry[i - 1].value = row_value;
+            new_entry[i - 1].row = i - 1;
+            new_entry[i - 1].next = hash_table[row_value % hash_size];
+            hash_table[row_value % hash_size] = &new_entry[i - 1];
+        }
+
+        tv->columns[col-1].hash_table = hash_table;
+        tv->columns[col-1].hash_size = hash_size;
+    }
+
+    if( !*handle )
+        entry = tv->columns[col-1].hash_table[val % tv->columns[col-1].hash_size];
+    else
+        entry = (*handle)->next;
+
+    while (entry && entry->value != val)
+        entry = entry->next;
+
+    *handle = entry;
+    if (!entry)
+        return ERROR_NO_MORE_ITEMS;
+
+    *row = entry->row;
+
+    return ERROR_SUCCESS;
+}
+
 static UINT get_stream_name( const MSITABLEVIEW *tv, UINT row, WCHAR **pstname )
 {
     LPWSTR p, stname = NULL;
@@ -1163,6 +1237,17 @@ static UINT TABLE_fetch_stream( struct tagMSIVIEW *view, UINT row, UINT col, ISt
     return r;
 }
 
+static void table_reset_hash_tables( MSITABLEVIEW *tv )
+{
+    UINT i;
+
+    for (i = 0; i < tv->num_cols; i++)
+    {
+        msi_free( tv->columns[i].hash_table );
+        tv->columns[i].hash_table = NULL;
+    }
+}
+
 /* Set a table value, i.e. preadjusted integer or string ID. */
 static UINT table_set_bytes( MSITABLEVIEW *tv, UINT row, UINT col, UINT val )
 {
@@ -1184,9 +1269,6 @@ static UINT table_set_bytes( MSITABLEVIEW *tv, UINT row, UINT col, UINT val )
         return ERROR_FUNCTION_FAILED;
     }
 
-    msi_free( tv->columns[col-1].hash_table );
-    tv->columns[col-1].hash_table = NULL;
-
     n = bytes_per_column( tv->db, &tv->columns[col - 1], LONG_STR_BYTES );
     if ( n != 2 && n != 3 && n != 4 )
     {
@@ -1195,6 +1277,12 @@ static UINT table_set_bytes( MSITABLEVIEW *tv, UINT row, UINT col, UINT val )
     }
 
     offset = tv->columns[col-1].offset;
+    if ( read_table_int( tv->table->data, row, offset, n ) == val )
+        return ERROR_SUCCESS;
+
+    msi_free( tv->columns[col-1].hash_table );
+    tv->columns[col-1].hash_table = NULL;
+
     for ( i = 0; i < n; i++ )
         tv->table->data[row][offset + i] = (val >> i * 8) & 0xff;
 
@@ -1742,6 +1830,9 @@ static UINT TABLE_insert_row( struct tagMSIVIEW *view, MSIRECORD *rec, UINT row,
     if( r != ERROR_SUCCESS )
         return r;
 
+    /* the row numbers stored in the hash tables are about to change */
+    table_reset_hash_tables( tv );
+
     /* shift the rows to make room for the new row */
     for (i = tv->table->row_count - 1; i > row; i--)
     {
@@ -1776,11 +1867,7 @@ static UINT TABLE_delete_row( struct tagMSIVIEW *view, UINT row )
     tv->table->row_count--;
 
     /* reset the hash tables */
-    for (i = 0; i < tv->num_cols; i++)
-    {
-        msi_free( tv->columns[i].hash_table );
-        tv->columns[i].hash_table = NULL;
-    }
+    table_reset_hash_tables( tv );
 
     for (i = row + 1; i < num_rows; i++)
     {
@@ -2144,6 +2231,7 @@ static const MSIVIEWOPS table_ops =
     TABLE_add_column,
     NULL,
     TABLE_drop,
+    TABLE_find_matching_rows,
 };
 
 UINT TABLE_CreateView( MSIDATABASE *db, LPCWSTR name, MSIVIEW **view )
@@ -2484,17 +2572,23 @@ static UINT msi_row_matches( MSITABLEVIEW *tv, UINT row, const UINT *data, UINT
 static UINT msi_table_find_row( MSITABLEVIEW *tv, MSIRECORD *rec, UINT *row, UINT *column )
 {
     UINT i, r = ERROR_FUNCTION_FAILED, *data;
+    MSIITERHANDLE handle = NULL;
 
     data = msi_record_to_row( tv, rec );
     if( !data )
         return r;
-    for( i = 0; i < tv->table->row_count; i++ )
+
+    /* only rows matching the first key column can match the whole key */
+    for( i = 0; i < tv->num_cols; i++ )
+        if( tv->columns[i].type & MSITYPE_KEY ) break;
+
+    if( i < tv->num_cols )
     {
-        r = msi_row_matches( tv, i, data, column );
-        if( r == ERROR_SUCCESS )
+        while (TABLE_find_matching_rows( &tv->view, i + 1, data[i], row, &handle ) == ERROR_SUCCESS)
         {
-            *row = i;
-            break;
+            r = msi_row_matches( tv, *row, data, column );
+            if( r == ERROR_SUCCESS )
+                break;
         }
     }
     msi_free( data );
@@ -2161,6 +2161,146 @@ static void test_where(void)
     DeleteFileA(msifile);
 }
 
+static void test_where_lookup(void)
+{
+    MSIHANDLE hdb, view, rec, params;
+    char buffer[32];
+    const char *query;
+    UINT r, i;
+
+    hdb = create_db();
+    ok( hdb, "failed to create db\n" );
+
+    r = run_query( hdb, 0, "CREATE TABLE `Comp` (`Comp` CHAR(32) NOT NULL, `Dir` CHAR(32), "
+                           "`Attr` SHORT, `Size` LONG PRIMARY KEY `Comp`)" );
+    ok( r == ERROR_SUCCESS, "failed to create table: %u\n", r );
+
+    r = run_query( hdb, 0, "CREATE TABLE `Files` (`File` CHAR(32) NOT NULL, `Comp_` CHAR(32), "
+                           "`Seq` SHORT PRIMARY KEY `File`)" );
+    ok( r == ERROR_SUCCESS, "failed to create table: %u\n", r );
+
+    params = MsiCreateRecord( 4 );
+    for (i = 0; i < 200; i++)
+    {
+        sprintf( buffer, "comp%u", i );
+        MsiRecordSetStringA( params, 1, buffer );
+        sprintf( buffer, "dir%u", i % 10 );
+        MsiRecordSetStringA( params, 2, buffer );
+        MsiRecordSetInteger( params, 3, i % 7 );
+        MsiRecordSetInteger( params, 4, 100000 + i );
+        r = run_query( hdb, params, "INSERT INTO `Comp` (`Comp`, `Dir`, `Attr`, `Size`) VALUES (?, ?, ?, ?)" );
+        ok( r == ERROR_SUCCESS, "failed to insert row: %u\n", r );
+    }
+    for (i = 0; i < 400; i++)
+    {
+        sprintf( buffer, "file%u", i );
+        MsiRecordSetStringA( params, 1, buffer );
+        sprintf( buffer, "comp%u", i / 2 );
+        MsiRecordSetStringA( params, 2, buffer );
+        MsiRecordSetInteger( params, 3, i + 1 );
+        r = run_query( hdb, params, "INSERT INTO `Files` (`File`, `Comp_`, `Seq`) VALUES (?, ?, ?)" );
+        ok( r == ERROR_SUCCESS, "failed to insert row: %u\n", r );
+    }
+    MsiCloseHandle( params );
+
+    query = "SELECT `Dir`, `Size` FROM `Comp` WHERE `Comp` = 'comp123'";
+    r = do_query( hdb, query, &rec );
+    ok( r == ERROR_SUCCESS, "query failed: %u\n", r );
+    check_record( rec, 2, "dir3", "100123" );
+    MsiCloseHandle( rec );
+
+    query = "SELECT `Comp` FROM `Comp` WHERE `Size` = 100042";
+    r = do_query( hdb, query, &rec );
+    ok( r == ERROR_SUCCESS, "query failed: %u\n", r );
+    check_record( rec, 1, "comp42" );
+    MsiCloseHandle( rec );
+
+    query = "SELECT `Comp` FROM `Comp` WHERE `Comp` = 'nosuchcomp'";
+    r = do_query( hdb, query, &rec );
+    ok( r == ERROR_NO_MORE_ITEMS, "query failed: %u\n", r );
+
+    /* the lookup value comes from the second marker */
+    params = MsiCreateRecord( 2 );
+    MsiRecordSetInteger( params, 1, 2 );
+    MsiRecordSetStringA( params, 2, "comp150" );
+    r = MsiDatabaseOpenViewA( hdb, "SELECT `Comp` FROM `Comp` WHERE `Attr` > ? AND `Comp` = ?", &view );
+    ok( r == ERROR_SUCCESS, "failed to open view: %u\n", r );
+    r = MsiViewExecute( view, params );
+    ok( r == ERROR_SUCCESS, "failed to execute view: %u\n", r );
+    r = MsiViewFetch( view, &rec );
+    ok( r == ERROR_SUCCESS, "failed to fetch: %u\n", r );
+    check_record( rec, 1, "comp150" );
+    MsiCloseHandle( rec );
+    r = MsiViewFetch( view, &rec );
+    ok( r == ERROR_NO_MORE_ITEMS, "got %u\n", r );
+    MsiViewClose( view );
+    MsiCloseHandle( view );
+    MsiCloseHandle( params );
+
+    query = "SELECT `File`, `Dir` FROM `Files`, `Comp` WHERE `Comp_` = `Comp` AND `Seq` >= 199 AND `Seq` <= 201";
+    r = MsiDatabaseOpenViewA( hdb, query, &view );
+    ok( r == ERROR_SUCCESS, "failed to open view: %u\n", r );
+    r = MsiViewExecute( view, 0 );
+    ok( r == ERROR_SUCCESS, "failed to execute view: %u\n", r );
+    r = MsiViewFetch( view, &rec );
+    ok( r == ERROR_SUCCESS, "failed to fetch: %u\n", r );
+    check_record( rec, 2, "file198", "dir9" );
+    MsiCloseHandle( rec );
+    r = MsiViewFetch( view, &rec );
+    ok( r == ERROR_SUCCESS, "failed to fetch: %u\n", r );
+    check_record( rec, 2, "file199", "dir9" );
+    MsiCloseHandle( rec );
+    r = MsiViewFetch( view, &rec );
+    ok( r == ERROR_SUCCESS, "failed to fetch: %u\n", r );
+    check_record( rec, 2, "file200", "dir0" );
+    MsiCloseHandle( rec );
+    r = MsiViewFetch( view, &rec );
+    ok( r == ERROR_NO_MORE_ITEMS, "got %u\n", r );
+    MsiViewClose( view );
+    MsiCloseHandle( view );
+
+    /* lookups after the table has changed */
+    r = run_query( hdb, 0, "UPDATE `Comp` SET `Size` = 5 WHERE `Comp` = 'comp42'" );
+    ok( r == ERROR_SUCCESS, "failed to update: %u\n", r );
+
+    query = "SELECT `Comp` FROM `Comp` WHERE `Size` = 100042";
+    r = do_query( hdb, query, &rec );
+    ok( r == ERROR_NO_MORE_ITEMS, "query failed: %u\n", r );
+
+    query = "SELECT `Comp` FROM `Comp` WHERE `Size` = 5";
+    r = do_query( hdb, query, &rec );
+    ok( r == ERROR_SUCCESS, "query failed: %u\n", r );
+    check_record( rec, 1, "comp42" );
+    MsiCloseHandle( rec );
+
+    r = run_query( hdb, 0, "DELETE FROM `Comp` WHERE `Comp` = 'comp10'" );
+    ok( r == ERROR_SUCCESS, "failed to delete: %u\n", r );
+
+    query = "SELECT `Size` FROM `Comp` WHERE `Comp` = 'comp11'";
+    r = do_query( hdb, query, &rec );
+    ok( r == ERROR_SUCCESS, "query failed: %u\n", r );
+    check_record( rec, 1, "100011" );
+    MsiCloseHandle( rec );
+
+    r = run_query( hdb, 0, "INSERT INTO `Comp` (`Comp`, `Dir`, `Attr`, `Size`) VALUES ('comp0a', 'dirA', 1, 7)" );
+    ok( r == ERROR_SUCCESS, "failed to insert row: %u\n", r );
+
+    query = "SELECT `Size` FROM `Comp` WHERE `Comp` = 'comp0a'";
+    r = do_query( hdb, query, &rec );
+    ok( r == ERROR_SUCCESS, "query failed: %u\n", r );
+    check_record( rec, 1, "7" );
+    MsiCloseHandle( rec );
+
+    query = "SELECT `Size` FROM `Comp` WHERE `Comp` = 'comp199'";
+    r = do_query( hdb, query, &rec );
+    ok( r == ERROR_SUCCESS, "query failed: %u\n", r );
+    check_record( rec, 1, "100199" );
+    MsiCloseHandle( rec );
+
+    MsiCloseHandle( hdb );
+    DeleteFileA( msifile );
+}
+
 static CHAR CURR_DIR[MAX_PATH];
 
 static const CHAR test_data[] = "FirstPrimaryColumn\tSecondPrimaryColumn\tShortInt\tShortIntNullable\tLongInt\tLongIntNullable\tString\tLocalizableString\tLocalizableStringNullable\n"
@@ -9211,6 +9351,7 @@ START_TEST(db)
     test_binary();
     test_where_not_in_selected();
     test_where();
+    test_where_lookup();
     test_msiimport();
     test_binary_import();
     test_markers();
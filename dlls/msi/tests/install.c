@@ -463,6 +463,21 @@ static const CHAR rof_media_dat[] = "DiskId\tLastSequence\tDiskPrompt\tCabinet\t
                                     "Media\tDiskId\n"
                                     "1\t1\t\t\tDISK1\t\n";
 
+static const CHAR mf_file_dat[] = "File\tComponent_\tFileName\tFileSize\tVersion\tLanguage\tAttributes\tSequence\n"
+                                  "s72\ts72\tl255\ti4\tS72\tS20\tI2\ti2\n"
+                                  "File\tFile\n"
+                                  "maximus\tmaximus\tmaximus\t500\t\t\t8192\t1\n"
+                                  "augustus\tmaximus\taugustus\t500\t\t\t8192\t2\n"
+                                  "caesar\tmaximus\tcaesar\t500\t\t\t8192\t3\n"
+                                  "gaius\tmaximus\tgaius\t500\t\t\t8192\t4\n"
+                                  "nero\tmaximus\tnero\t500\t\t\t8192\t5\n"
+                                  "otho\tmaximus\totho\t500\t\t\t8192\t6";
+
+static const CHAR mf_media_dat[] = "DiskId\tLastSequence\tDiskPrompt\tCabinet\tVolumeLabel\tSource\n"
+                                   "i2\ti4\tL64\tS255\tS32\tS72\n"
+                                   "Media\tDiskId\n"
+                                   "1\t6\t\t\tDISK1\t\n";
+
 static const CHAR rofc_file_dat[] = "File\tComponent_\tFileName\tFileSize\tVersion\tLanguage\tAttributes\tSequence\n"
                                     "s72\ts72\tl255\ti4\tS72\tS20\tI2\ti2\n"
                                     "File\tFile\n"
@@ -1644,6 +1659,18 @@ static const msi_table rofc_tables[] =
     ADD_TABLE(property),
 };
 
+static const msi_table mf_tables[] =
+{
+    ADD_TABLE(rof_component),
+    ADD_TABLE(directory),
+    ADD_TABLE(rof_feature),
+    ADD_TABLE(rof_feature_comp),
+    ADD_TABLE(mf_file),
+    ADD_TABLE(install_exec_seq),
+    ADD_TABLE(mf_media),
+    ADD_TABLE(property),
+};
+
 static const msi_table sdp_tables[] =
 {
     ADD_TABLE(rof_component),
@@ -5413,6 +5440,113 @@ error:
     DeleteFileA(msifile);
 }
 
+static void test_multiple_files(void)
+{
+    static const char *files[] = {"maximus", "augustus", "caesar", "gaius", "nero", "otho"};
+    char path[MAX_PATH], source[MAX_PATH];
+    DWORD disposition = 0, old_type, old_size = 0;
+    BYTE old_value[MAX_PATH];
+    unsigned int i, pass;
+    HKEY hkey = NULL;
+    LONG res = 0;
+    UINT r;
+
+    if (is_process_limited())
+    {
+        skip("process is limited\n");
+        return;
+    }
+
+    CreateDirectoryA("msitest", NULL);
+    create_database(msifile, mf_tables, ARRAY_SIZE(mf_tables));
+
+    MsiSetInternalUI(INSTALLUILEVEL_NONE, NULL);
+
+    /* the second pass enables the parallel copy in Wine, other platforms
+     * ignore the setting; keep the user's value around */
+    if (!RegCreateKeyExA(HKEY_CURRENT_USER, "Software\\Wine\\Msi", 0, NULL, 0,
+                         KEY_ALL_ACCESS, NULL, &hkey, &disposition))
+    {
+        old_size = sizeof(old_value);
+        res = RegQueryValueExA(hkey, "InstallFilesThreads", NULL, &old_type, old_value, &old_size);
+        if (res == ERROR_MORE_DATA)
+        {
+            skip("InstallFilesThreads value is too large to be restored\n");
+            RegCloseKey(hkey);
+            hkey = NULL;
+            goto error;
+        }
+    }
+
+    for (pass = 0; pass < 2; pass++)
+    {
+        if (hkey)
+        {
+            DWORD threads = pass ? 4 : 1;
+
+            RegSetValueExA(hkey, "InstallFilesThreads", 0, REG_DWORD, (const BYTE *)&threads, sizeof(threads));
+        }
+
+        for (i = 0; i < ARRAY_SIZE(files); i++)
+        {
+            sprintf(source, "msitest\\%s", files[i]);
+            create_file(source, 500);
+        }
+
+        r = MsiInstallProductA(msifile, NULL);
+        if (r == ERROR_INSTALL_PACKAGE_REJECTED)
+        {
+            skip("Not enough rights to perform tests\n");
+            goto error;
+        }
+        ok(r == ERROR_SUCCESS, "%u: Expected ERROR_SUCCESS, got %u\n", pass, r);
+        for (i = 0; i < ARRAY_SIZE(files); i++)
+        {
+            sprintf(path, "%s\\msitest\\%s", PROG_FILES_DIR, files[i]);
+            sprintf(source, "msitest\\%s", files[i]);
+            ok(file_matches_data(path, source), "%u: Expected %s to match\n", pass, files[i]);
+        }
+
+        r = MsiInstallProductA(msifile, "REMOVE=ALL");
+        ok(r == ERROR_SUCCESS, "%u: Expected ERROR_SUCCESS, got %u\n", pass, r);
+        for (i = 0; i < ARRAY_SIZE(files); i++)
+        {
+            sprintf(path, "msitest\\%s", files[i]);
+            ok(!delete_pf(path, TRUE), "%u: File %s not removed\n", pass, files[i]);
+        }
+
+        /* a missing source file fails the install */
+        DeleteFileA("msitest\\caesar");
+        r = MsiInstallProductA(msifile, NULL);
+        ok(r == ERROR_INSTALL_FAILURE, "%u: Expected ERROR_INSTALL_FAILURE, got %u\n", pass, r);
+        ok(!delete_pf("msitest\\caesar", TRUE), "%u: File installed\n", pass);
+        for (i = 0; i < ARRAY_SIZE(files); i++)
+        {
+            sprintf(path, "msitest\\%s", files[i]);
+            delete_pf(path, TRUE);
+        }
+        delete_pf("msitest", FALSE);
+    }
+
+error:
+    if (hkey)
+    {
+        if (!res) RegSetValueExA(hkey, "InstallFilesThreads", 0, old_type, old_value, old_size);
+        else RegDeleteValueA(hkey, "InstallFilesThreads");
+        RegCloseKey(hkey);
+        if (disposition == REG_CREATED_NEW_KEY) RegDeleteKeyA(HKEY_CURRENT_USER, "Software\\Wine\\Msi");
+    }
+    for (i = 0; i < ARRAY_SIZE(files); i++)
+    {
+        sprintf(path, "msitest\\%s", files[i]);
+        delete_pf(path, TRUE);
+        DeleteFileA(path);
+    }
+    delete_pf("msitest", FALSE);
+    RemoveDirectoryA("msitest");
+    DeleteFileA(msifile);
+}
+
 static void test_feature_override(void)
 {
     UINT r;
@@ -6308,6 +6442,7 @@ START_TEST(install)
     test_installed_prop();
     test_file_in_use();
     test_file_in_use_cab();
+    test_multiple_files();
     test_allusers_prop();
     test_feature_override();
     test_icon_table();
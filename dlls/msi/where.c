@@ -646,22 +646,162 @@ static UINT WHERE_evaluate( MSIWHEREVIEW *wv, const UINT rows[],
     return ERROR_SUCCESS;
 }
 
+static BOOL is_table_column( const struct expr *expr, const JOINTABLE *table )
+{
+    return (expr->type == EXPR_COL_NUMBER || expr->type == EXPR_COL_NUMBER32 ||
+            expr->type == EXPR_COL_NUMBER_STRING) && expr->u.column.parsed.table == table;
+}
+
+static UINT count_wildcards( const struct expr *expr )
+{
+    switch (expr->type)
+    {
+    case EXPR_WILDCARD:
+        return 1;
+    case EXPR_COMPLEX:
+    case EXPR_STRCMP:
+        return count_wildcards( expr->u.expr.left ) + count_wildcards( expr->u.expr.right );
+    default:
+        return 0;
+    }
+}
+
+/* gets the value an indexed column has to be equal to, as returned by fetch_int */
+static BOOL get_lookup_value( MSIWHEREVIEW *wv, const struct expr *column, const struct expr *expr,
+                              const UINT rows[], MSIRECORD *record, UINT rec_index, UINT *val )
+{
+    const WCHAR *str;
+    UINT r, tval;
+    INT ival;
+
+    if (expr->type == EXPR_COL_NUMBER || expr->type == EXPR_COL_NUMBER32 ||
+        expr->type == EXPR_COL_NUMBER_STRING)
+    {
+        r = expr_fetch_value( &expr->u.column, rows, &tval );
+        if (r != ERROR_SUCCESS)
+            return FALSE;
+    }
+
+    if (column->type == EXPR_COL_NUMBER_STRING)
+    {
+        switch (expr->type)
+        {
+        case EXPR_COL_NUMBER_STRING:
+            str = msi_string_lookup( wv->db->strings, tval, NULL );
+            break;
+        case EXPR_SVAL:
+            str = expr->u.sval;
+            break;
+        case EXPR_WILDCARD:
+            str = MSI_RecordGetString( record, rec_index );
+            break;
+        default:
+            return FALSE;
+        }
+
+        /* null and empty strings compare equal */
+        if (!str || !*str)
+            return FALSE;
+
+        return msi_string2id( wv->db->strings, str, -1, val ) == ERROR_SUCCESS;
+    }
+
+    switch (expr->type)
+    {
+    case EXPR_COL_NUMBER:
+        ival = tval - 0x8000;
+        break;
+    case EXPR_COL_NUMBER32:
+        ival = tval - 0x80000000;
+        break;
+    case EXPR_UVAL:
+        ival = expr->u.uval;
+        break;
+    case EXPR_WILDCARD:
+        ival = MSI_RecordGetInteger( record, rec_index );
+        break;
+    default:
+        return FALSE;
+    }
+
+    if (column->type == EXPR_COL_NUMBER32)
+        *val = ival + 0x80000000;
+    else
+        *val = ival + 0x8000;
+    return TRUE;
+}
+
+/* Looks for an equality comparison that has to hold for the condition to be
+ * true, between a column of the table and a value that is known once the
+ * tables preceding it in the join have been positioned. The rows of the table
+ * to check can then be looked up instead of scanning the whole table. */
+static BOOL find_lookup_column( MSIWHEREVIEW *wv, const struct expr *cond, const JOINTABLE *table,
+                                const UINT rows[], MSIRECORD *record, UINT *rec_index,
+                                UINT *col, UINT *val )
+{
+    const struct expr *left, *right;
+
+    if (cond->type == EXPR_COMPLEX && cond->u.expr.op == OP_AND)
+    {
+        if (find_lookup_column( wv, cond->u.expr.left, table, rows, record, rec_index, col, val ))
+            return TRUE;
+        return find_lookup_column( wv, cond->u.expr.right, table, rows, record, rec_index, col, val );
+    }
+
+    if ((cond->type == EXPR_COMPLEX || cond->type == EXPR_STRCMP) && cond->u.expr.op == OP_EQ)
+    {
+        left = cond->u.expr.left;
+        right = cond->u.expr.right;
+
+        if (is_table_column( left, table ) &&
+            get_lookup_value( wv, left, right, rows, record, *rec_index + 1, val ))
+        {
+            *col = left->u.column.parsed.column;
+            return TRUE;
+        }
+        if (is_table_column( right, table ) &&
+            get_lookup_value( wv, right, left, rows, record, *rec_index + 1, val ))
+        {
+            *col = right->u.column.parsed.column;
+            return TRUE;
+        }
+    }
+
+    *rec_index += count_wildcards( cond );
+    return FALSE;
+}
+
 static UINT check_condition( MSIWHEREVIEW *wv, MSIRECORD *record, JOINTABLE **tables,
                              UINT table_rows[] )
 {
-    UINT r = ERROR_FUNCTION_FAILED;
-    INT val;
+    UINT r = ERROR_SUCCESS;
+    JOINTABLE *table = *tables;
+    MSIITERHANDLE handle = NULL;
+    UINT col, val, row, rec_index = 0;
+    BOOL lookup = FALSE;
+    INT cond_val;
+
+    if (wv->cond && table->view->ops->find_matching_rows)
+        lookup = find_lookup_column( wv, wv->cond, table, table_rows, record, &rec_index, &col, &val );
 
-    for (table_rows[(*tables)->table_index] = 0;
-         table_rows[(*tables)->table_index] < (*tables)->row_count;
-         table_rows[(*tables)->table_index]++)
+    for (row = 0;; row++)
     {
-        val = 0;
+        if (lookup)
+        {
+            if (table->view->ops->find_matching_rows( table->view, col, val, &row, &handle ))
+                break;
+        }
+        else if (row >= table->row_count)
+            break;
+
+        table_rows[table->table_index] = row;
+
+        cond_val = 0;
         wv->rec_index = 0;
-        r = WHERE_evaluate( wv, table_rows, wv->cond, &val, record );
+        r = WHERE_evaluate( wv, table_rows, wv->cond, &cond_val, record );
         if (r != ERROR_SUCCESS && r != ERROR_CONTINUE)
             break;
-        if (val)
+        if (cond_val)
         {
             if (*(tables + 1))
             {
@@ -677,7 +817,7 @@ static UINT check_condition( MSIWHEREVIEW *wv, MSIRECORD *record, JOINTABLE **ta
             }
         }
     }
-    table_rows[(*tables)->table_index] = INVALID_ROW_INDEX;
+    table_rows[table->table_index] = INVALID_ROW_INDEX;
     return r;
 }
 
@@ -1369,15 +1369,18 @@ NTSTATUS WINAPI NtRemoveIoCompletion( HANDLE CompletionPort, PULONG_PTR Completi
 
     for(;;)
     {
+        struct completion_msg msg;
+
         SERVER_START_REQ( remove_completion )
         {
             req->handle = wine_server_obj_handle( CompletionPort );
+            wine_server_set_reply( req, &msg, sizeof(msg) );
             if (!(status = wine_server_call( req )))
             {
-                *CompletionKey    = reply->ckey;
-                *CompletionValue  = reply->cvalue;
-                iosb->Information = reply->information;
-                iosb->u.Status    = reply->status;
+                *CompletionKey    = msg.ckey;
+                *CompletionValue  = msg.cvalue;
+                iosb->Information = msg.information;
+                iosb->u.Status    = msg.status;
             }
         }
         SERVER_END_REQ;
@@ -1396,31 +1399,39 @@ NTSTATUS WINAPI NtRemoveIoCompletion( HANDLE CompletionPort, PULONG_PTR Completi
 NTSTATUS WINAPI NtRemoveIoCompletionEx( HANDLE port, FILE_IO_COMPLETION_INFORMATION *info, ULONG count,
                                         ULONG *written, LARGE_INTEGER *timeout, BOOLEAN alertable )
 {
+    struct completion_msg msgs[64];
     NTSTATUS ret;
-    ULONG i = 0;
+    ULONG i = 0, j, requested, received;
 
     TRACE("%p %p %u %p %p %u\n", port, info, count, written, timeout, alertable);
 
     for (;;)
     {
+        /* dequeue as many completions as possible with each request */
         while (i < count)
         {
+            requested = min( count - i, ARRAY_SIZE(msgs) );
             SERVER_START_REQ( remove_completion )
             {
                 req->handle = wine_server_obj_handle( port );
-                if (!(ret = wine_server_call( req )))
-                {
-                    info[i].CompletionKey             = reply->ckey;
-                    info[i].CompletionValue           = reply->cvalue;
-                    info[i].IoStatusBlock.Information = reply->information;
-                    info[i].IoStatusBlock.u.Status    = reply->status;
-                }
+                wine_server_set_reply( req, msgs, requested * sizeof(msgs[0]) );
+                ret = wine_server_call( req );
+                received = wine_server_reply_size( reply ) / sizeof(msgs[0]);
             }
             SERVER_END_REQ;
 
             if (ret != STATUS_SUCCESS) break;
 
-            ++i;
+            for (j = 0; j < received; j++, i++)
+            {
+                info[i].CompletionKey             = msgs[j].ckey;
+                info[i].CompletionValue           = msgs[j].cvalue;
+                info[i].IoStatusBlock.Information = msgs[j].information;
+                info[i].IoStatusBlock.u.Status    = msgs[j].status;
+            }
+
+            /* a short reply means that the queue is now empty */
+            if (received < requested) break;
         }
 
         if (i || ret != STATUS_PENDING)
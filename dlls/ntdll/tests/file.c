@@ -917,9 +917,9 @@ static void WINAPI user_apc_proc(ULONG_PTR arg)
 
 static void test_set_io_completion(void)
 {
-    FILE_IO_COMPLETION_INFORMATION info[2] = {{0}};
+    FILE_IO_COMPLETION_INFORMATION info[2] = {{0}}, batch[150];
     LARGE_INTEGER timeout = {{0}};
-    unsigned int apc_count;
+    unsigned int apc_count, i;
     IO_STATUS_BLOCK iosb;
     ULONG_PTR key, value;
     NTSTATUS res;
@@ -1024,6 +1024,49 @@ static void test_set_io_completion(void)
         info[0].IoStatusBlock.Information );
     ok( U(info[0].IoStatusBlock).Status == 56, "wrong status %#x\n", U(info[0].IoStatusBlock).Status);
 
+    /* batches larger than what is fetched with a single server request */
+    for (i = 0; i < 100; i++)
+    {
+        res = pNtSetIoCompletion( h, i, i + 1000, i + 2000, size );
+        ok( res == STATUS_SUCCESS, "NtSetIoCompletion failed: %#x\n", res );
+    }
+
+    count = 0xdeadbeef;
+    res = pNtRemoveIoCompletionEx( h, batch, ARRAY_SIZE(batch), &count, &timeout, FALSE );
+    ok( res == STATUS_SUCCESS, "NtRemoveIoCompletionEx failed: %#x\n", res );
+    ok( count == 100, "wrong count %u\n", count );
+    for (i = 0; i < min( count, 100 ); i++)
+    {
+        ok( batch[i].CompletionKey == i, "%u: wrong key %#lx\n", i, batch[i].CompletionKey );
+        ok( batch[i].CompletionValue == i + 1000, "%u: wrong value %#lx\n", i, batch[i].CompletionValue );
+        ok( U(batch[i].IoStatusBlock).Status == i + 2000, "%u: wrong status %#x\n",
+            i, U(batch[i].IoStatusBlock).Status );
+    }
+
+    count = get_pending_msgs(h);
+    ok( !count, "Unexpected msg count: %d\n", count );
+
+    for (i = 0; i < 70; i++)
+    {
+        res = pNtSetIoCompletion( h, i, 0, 0, size );
+        ok( res == STATUS_SUCCESS, "NtSetIoCompletion failed: %#x\n", res );
+    }
+
+    count = 0xdeadbeef;
+    res = pNtRemoveIoCompletionEx( h, batch, 65, &count, &timeout, FALSE );
+    ok( res == STATUS_SUCCESS, "NtRemoveIoCompletionEx failed: %#x\n", res );
+    ok( count == 65, "wrong count %u\n", count );
+    ok( batch[64].CompletionKey == 64, "wrong key %#lx\n", batch[64].CompletionKey );
+
+    count = get_pending_msgs(h);
+    ok( count == 5, "Unexpected msg count: %d\n", count );
+
+    count = 0xdeadbeef;
+    res = pNtRemoveIoCompletionEx( h, batch, ARRAY_SIZE(batch), &count, &timeout, FALSE );
+    ok( res == STATUS_SUCCESS, "NtRemoveIoCompletionEx failed: %#x\n", res );
+    ok( count == 5, "wrong count %u\n", count );
+    ok( batch[0].CompletionKey == 65, "wrong key %#lx\n", batch[0].CompletionKey );
+
     apc_count = 0;
     QueueUserAPC( user_apc_proc, GetCurrentThread(), (ULONG_PTR)&apc_count );
 
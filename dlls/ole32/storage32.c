@@ -3543,6 +3543,111 @@ static ULONGLONG StorageImpl_GetBigBlockOffset(StorageImpl* This, ULONG index)
     return (ULONGLONG)(index+1) * This->bigBlockSize;
 }
 
+typedef struct BigBlockCacheEntry
+{
+  struct list lru_entry;
+  struct list hash_entry;
+  ULONG index;
+  BYTE data[1];
+} BigBlockCacheEntry;
+
+static void StorageImpl_InitBlockCache(StorageImpl* This)
+{
+  DWORD share = STGM_SHARE_MODE(This->base.openFlags);
+  int i;
+
+  list_init(&This->bigBlockCacheLRU);
+  for (i = 0; i < BIGBLOCK_CACHE_BUCKETS; i++)
+    list_init(&This->bigBlockCacheBuckets[i]);
+
+  /* Blocks could be changed behind our back if the file is shared for writing. */
+  This->bigBlockCacheEnabled = This->base.lockingrole == SWMR_None &&
+    (share == STGM_SHARE_EXCLUSIVE || share == STGM_SHARE_DENY_WRITE);
+}
+
+static void StorageImpl_InvalidateBlockCache(StorageImpl* This)
+{
+  BigBlockCacheEntry *entry, *next;
+
+  LIST_FOR_EACH_ENTRY_SAFE(entry, next, &This->bigBlockCacheLRU, BigBlockCacheEntry, lru_entry)
+  {
+    list_remove(&entry->lru_entry);
+    list_remove(&entry->hash_entry);
+    HeapFree(GetProcessHeap(), 0, entry);
+  }
+  This->bigBlockCacheCount = 0;
+}
+
+static BigBlockCacheEntry* StorageImpl_FindCachedBlock(StorageImpl* This, ULONG blockIndex)
+{
+  struct list *bucket = &This->bigBlockCacheBuckets[blockIndex & (BIGBLOCK_CACHE_BUCKETS-1)];
+  BigBlockCacheEntry *entry;
+
+  LIST_FOR_EACH_ENTRY(entry, bucket, BigBlockCacheEntry, hash_entry)
+  {
+    if (entry->index == blockIndex)
+    {
+      list_remove(&entry->lru_entry);
+      list_add_head(&This->bigBlockCacheLRU, &entry->lru_entry);
+      return entry;
+    }
+  }
+
+  return NULL;
+}
+
+static void StorageImpl_CacheBlock(StorageImpl* This, ULONG blockIndex, const void* buffer)
+{
+  BigBlockCacheEntry *entry;
+
+  if (!This->bigBlockCacheEnabled)
+    return;
+
+  if (!(entry = StorageImpl_FindCachedBlock(This, blockIndex)))
+  {
+    if (This->bigBlockCacheCount < BIGBLOCK_CACHE_SIZE)
+    {
+      entry = HeapAlloc(GetProcessHeap(), 0, FIELD_OFFSET(BigBlockCacheEntry, data[This->bigBlockSize]));
+      if (!entry)
+        return;
+      This->bigBlockCacheCount++;
+    }
+    else
+    {
+      /* Evict the least recently used block. */
+      entry = LIST_ENTRY(list_tail(&This->bigBlockCacheLRU), BigBlockCacheEntry, lru_entry);
+      list_remove(&entry->lru_entry);
+      list_remove(&entry->hash_entry);
+    }
+
+    entry->index = blockIndex;
+    list_add_head(&This->bigBlockCacheLRU, &entry->lru_entry);
+    list_add_head(&This->bigBlockCacheBuckets[blockIndex & (BIGBLOCK_CACHE_BUCKETS-1)], &entry->hash_entry);
+  }
+
+  memcpy(entry->data, buffer, This->bigBlockSize);
+}
+
+/* Keeps a cached block in sync with data written directly to the file. */
+static void StorageImpl_UpdateCachedBlock(StorageImpl* This, ULONG blockIndex,
+  ULONG offset, const void* buffer, ULONG size, BOOL success)
+{
+  BigBlockCacheEntry *entry;
+
+  if (!This->bigBlockCacheCount)
+    return;
+
+  if (!success)
+  {
+    /* We don't know what ended up in the file. */
+    StorageImpl_InvalidateBlockCache(This);
+    return;
+  }
+
+  if ((entry = StorageImpl_FindCachedBlock(This, blockIndex)))
+    memcpy(entry->data + offset, buffer, size);
+}
+
 static HRESULT StorageImpl_ReadBigBlock(
   StorageImpl* This,
   ULONG          blockIndex,
@@ -3550,9 +3655,17 @@ static HRESULT StorageImpl_ReadBigBlock(
   ULONG*         out_read)
 {
   ULARGE_INTEGER ulOffset;
+  BigBlockCacheEntry *entry;
   DWORD  read=0;
   HRESULT hr;
 
+  if (This->bigBlockCacheCount && (entry = StorageImpl_FindCachedBlock(This, blockIndex)))
+  {
+    memcpy(buffer, entry->data, This->bigBlockSize);
+    if (out_read) *out_read = This->bigBlockSize;
+    return S_OK;
+  }
+
   ulOffset.QuadPart = StorageImpl_GetBigBlockOffset(This, blockIndex);
 
   hr = StorageImpl_ReadAt(This, ulOffset, buffer, This->bigBlockSize, &read);
@@ -3562,26 +3675,65 @@ static HRESULT StorageImpl_ReadBigBlock(
     /* File ends during this block; fill the rest with 0's. */
     memset((LPBYTE)buffer+read, 0, This->bigBlockSize-read);
   }
+  else if (SUCCEEDED(hr))
+  {
+    StorageImpl_CacheBlock(This, blockIndex, buffer);
+  }
 
   if (out_read) *out_read = read;
 
   return hr;
 }
 
+/* Reads part of a big block. When the cache is enabled the whole block is
+ * read and cached, so that later reads of the same block are served from
+ * memory. */
+static HRESULT StorageImpl_ReadFromBigBlock(
+  StorageImpl* This,
+  ULONG          blockIndex,
+  ULONG          offset,
+  void*          buffer,
+  ULONG          size,
+  ULONG*         out_read)
+{
+  BYTE block[MAX_BIG_BLOCK_SIZE];
+  ULARGE_INTEGER ulOffset;
+  BigBlockCacheEntry *entry;
+  ULONG read;
+  HRESULT hr;
+
+  if (This->bigBlockCacheCount && (entry = StorageImpl_FindCachedBlock(This, blockIndex)))
+  {
+    memcpy(buffer, entry->data + offset, size);
+    *out_read = size;
+    return S_OK;
+  }
+
+  if (!This->bigBlockCacheEnabled)
+  {
+    ulOffset.QuadPart = StorageImpl_GetBigBlockOffset(This, blockIndex) + offset;
+    return StorageImpl_ReadAt(This, ulOffset, buffer, size, out_read);
+  }
+
+  if (offset == 0 && size == This->bigBlockSize)
+    return StorageImpl_ReadBigBlock(This, blockIndex, buffer, out_read);
+
+  hr = StorageImpl_ReadBigBlock(This, blockIndex, block, &read);
+  *out_read = read > offset ? min(read - offset, size) : 0;
+  memcpy(buffer, block + offset, *out_read);
+  return hr;
+}
+
 static BOOL StorageImpl_ReadDWordFromBigBlock(
   StorageImpl*  This,
   ULONG         blockIndex,
   ULONG         offset,
   DWORD*        value)
 {
-  ULARGE_INTEGER ulOffset;
-  DWORD  read;
+  ULONG  read;
   DWORD  tmp;
 
-  ulOffset.QuadPart = StorageImpl_GetBigBlockOffset(This, blockIndex);
-  ulOffset.QuadPart += offset;
-
-  StorageImpl_ReadAt(This, ulOffset, &tmp, sizeof(DWORD), &read);
+  StorageImpl_ReadFromBigBlock(This, blockIndex, offset, &tmp, sizeof(DWORD), &read);
   *value = lendian32toh(tmp);
   return (read == sizeof(DWORD));
 }
@@ -3597,6 +3749,7 @@ static BOOL StorageImpl_WriteBigBlock(
   ulOffset.QuadPart = StorageImpl_GetBigBlockOffset(This, blockIndex);
 
   StorageImpl_WriteAt(This, ulOffset, buffer, This->bigBlockSize, &wrote);
+  StorageImpl_UpdateCachedBlock(This, blockIndex, 0, buffer, This->bigBlockSize, wrote == This->bigBlockSize);
   return (wrote == This->bigBlockSize);
 }
 
@@ -3614,6 +3767,7 @@ static BOOL StorageImpl_WriteDWordToBigBlock(
 
   value = htole32(value);
   StorageImpl_WriteAt(This, ulOffset, &value, sizeof(DWORD), &wrote);
+  StorageImpl_UpdateCachedBlock(This, blockIndex, offset, &value, sizeof(DWORD), wrote == sizeof(DWORD));
   return (wrote == sizeof(DWORD));
 }
 
@@ -4627,6 +4781,8 @@ static HRESULT StorageImpl_Refresh(StorageImpl *This, BOOL new_object, BOOL crea
   DirRef      currentEntryRef;
   BlockChainStream *blockChainStream;
 
+  StorageImpl_InvalidateBlockCache(This);
+
   if (create)
   {
     ULARGE_INTEGER size;
@@ -5202,6 +5358,8 @@ static void StorageImpl_Destroy(StorageBaseImpl* iface)
   for (i = 0; i < BLOCKCHAIN_CACHE_SIZE; i++)
     BlockChainStream_Destroy(This->blockChainCache[i]);
 
+  StorageImpl_InvalidateBlockCache(This);
+
   for (i = 0; i < ARRAY_SIZE(This->locked_bytes); i++)
   {
     ULARGE_INTEGER offset, cb;
@@ -5312,6 +5470,7 @@ static HRESULT StorageImpl_Construct(
   /*
    * Initialize the big block cache.
    */
+  StorageImpl_InitBlockCache(This);
   This->bigBlockSize   = sector_size;
   This->smallBlockSize = DEF_SMALL_BLOCK_SIZE;
   if (hFile)
@@ -7638,8 +7797,7 @@ HRESULT BlockChainStream_ReadAt(BlockChainStream* This,
 
   while (size > 0)
   {
-    ULARGE_INTEGER ulOffset;
-    DWORD bytesReadAt;
+    ULONG bytesReadAt;
 
     /*
      * Calculate how many bytes we can copy from this big block.
@@ -7655,11 +7813,9 @@ HRESULT BlockChainStream_ReadAt(BlockChainStream* This,
     if (!cachedBlock)
     {
       /* Not in cache, and we're going to read past the end of the block. */
-      ulOffset.QuadPart = StorageImpl_GetBigBlockOffset(This->parentStorage, blockIndex) +
-                               offsetInBlock;
-
-      StorageImpl_ReadAt(This->parentStorage,
-           ulOffset,
+      StorageImpl_ReadFromBigBlock(This->parentStorage,
+           blockIndex,
+           offsetInBlock,
            bufferWalker,
            bytesToReadInBuffer,
            &bytesReadAt);
@@ -7747,6 +7903,8 @@ HRESULT BlockChainStream_WriteAt(BlockChainStream* This,
            bufferWalker,
            bytesToWrite,
            &bytesWrittenAt);
+      StorageImpl_UpdateCachedBlock(This->parentStorage, blockIndex, offsetInBlock,
+           bufferWalker, bytesToWrite, bytesWrittenAt == bytesToWrite);
     }
     else
     {
@@ -362,6 +362,11 @@ void StorageBaseImpl_RemoveStream(StorageBaseImpl * stg, StgStreamImpl * strm) D
 /* Number of BlockChainStream objects to cache in a StorageImpl */
 #define BLOCKCHAIN_CACHE_SIZE 4
 
+/* Number of big blocks to cache in a StorageImpl, and the number of hash
+ * buckets used to look them up (must be a power of 2) */
+#define BIGBLOCK_CACHE_SIZE 256
+#define BIGBLOCK_CACHE_BUCKETS 64
+
 /****************************************************************************
  * StorageImpl definitions.
  *
@@ -411,6 +416,12 @@ struct StorageImpl
   BlockChainStream* blockChainCache[BLOCKCHAIN_CACHE_SIZE];
   UINT blockChainToEvict;
 
+  /* Write-through cache of big blocks, only used when nobody else can write to the file */
+  BOOL bigBlockCacheEnabled;
+  ULONG bigBlockCacheCount;
+  struct list bigBlockCacheLRU;
+  struct list bigBlockCacheBuckets[BIGBLOCK_CACHE_BUCKETS];
+
   ULONG locks_supported;
 
   ILockBytes* lockBytes;
@@ -3871,6 +3871,118 @@ static void test_overwrite(void)
     DeleteFileA(filenameA);
 }
 
+static void check_stream_data(IStream *stm, const BYTE *expected, ULONG size, const char *context)
+{
+    BYTE buffer[1000];
+    LARGE_INTEGER pos;
+    ULONG offset, len, read;
+    HRESULT r;
+
+    for (offset = 0; offset < size; offset += len)
+    {
+        len = min(size - offset, sizeof(buffer));
+        pos.QuadPart = offset;
+        r = IStream_Seek(stm, pos, STREAM_SEEK_SET, NULL);
+        ok(r == S_OK, "%s: IStream->Seek failed %x\n", context, r);
+        r = IStream_Read(stm, buffer, len, &read);
+        ok(r == S_OK, "%s: IStream->Read failed %x\n", context, r);
+        ok(read == len, "%s: read %u bytes, expected %u\n", context, read, len);
+        if (memcmp(buffer, expected + offset, len))
+        {
+            ok(0, "%s: data mismatch at offset %u\n", context, offset);
+            break;
+        }
+    }
+}
+
+static void test_random_access(void)
+{
+    static const WCHAR *stmnames[2] = { strmA_name, strmB_name };
+    static const ULONG stream_size = 256 * 1024;
+    IStorage *stg = NULL;
+    IStream *stm[2];
+    BYTE *data[2], buffer[4096];
+    LARGE_INTEGER pos;
+    ULONG written, read, offset, len, seed = 0x1234;
+    HRESULT r;
+    int i, j;
+
+    DeleteFileA(filenameA);
+
+    r = StgCreateDocfile(filename, STGM_CREATE | STGM_READWRITE | STGM_SHARE_EXCLUSIVE, 0, &stg);
+    ok(r == S_OK, "StgCreateDocfile failed %x\n", r);
+
+    for (i = 0; i < 2; i++)
+    {
+        r = IStorage_CreateStream(stg, stmnames[i], STGM_SHARE_EXCLUSIVE | STGM_READWRITE, 0, 0, &stm[i]);
+        ok(r == S_OK, "IStorage->CreateStream failed %x\n", r);
+        data[i] = HeapAlloc(GetProcessHeap(), 0, stream_size);
+        for (j = 0; j < stream_size; j++) data[i][j] = (j * 7 + i) & 0xff;
+    }
+
+    /* interleave the writes so that both block chains are fragmented */
+    for (offset = 0; offset < stream_size; offset += sizeof(buffer))
+    {
+        for (i = 0; i < 2; i++)
+        {
+            r = IStream_Write(stm[i], data[i] + offset, sizeof(buffer), &written);
+            ok(r == S_OK, "IStream->Write failed %x\n", r);
+        }
+    }
+
+    for (j = 0; j < 2000; j++)
+    {
+        i = j & 1;
+        seed = seed * 1103515245 + 12345;
+        offset = (seed >> 8) % stream_size;
+        seed = seed * 1103515245 + 12345;
+        len = min((seed >> 8) % sizeof(buffer) + 1, stream_size - offset);
+        pos.QuadPart = offset;
+        r = IStream_Seek(stm[i], pos, STREAM_SEEK_SET, NULL);
+        ok(r == S_OK, "IStream->Seek failed %x\n", r);
+
+        if (j % 3)
+        {
+            r = IStream_Read(stm[i], buffer, len, &read);
+            ok(r == S_OK, "IStream->Read failed %x\n", r);
+            ok(read == len, "read %u bytes, expected %u\n", read, len);
+            if (memcmp(buffer, data[i] + offset, len))
+            {
+                ok(0, "data mismatch at offset %u in stream %d\n", offset, i);
+                break;
+            }
+        }
+        else
+        {
+            memset(data[i] + offset, j & 0xff, len);
+            r = IStream_Write(stm[i], data[i] + offset, len, &written);
+            ok(r == S_OK, "IStream->Write failed %x\n", r);
+        }
+    }
+
+    for (i = 0; i < 2; i++)
+    {
+        check_stream_data(stm[i], data[i], stream_size, "before reopen");
+        IStream_Release(stm[i]);
+    }
+    IStorage_Release(stg);
+
+    r = StgOpenStorage(filename, NULL, STGM_READ | STGM_SHARE_DENY_WRITE, NULL, 0, &stg);
+    ok(r == S_OK, "StgOpenStorage failed %x\n", r);
+
+    for (i = 0; i < 2; i++)
+    {
+        r = IStorage_OpenStream(stg, stmnames[i], NULL, STGM_SHARE_EXCLUSIVE | STGM_READ, 0, &stm[i]);
+        ok(r == S_OK, "IStorage->OpenStream failed %x\n", r);
+        check_stream_data(stm[i], data[i], stream_size, "after reopen");
+        IStream_Release(stm[i]);
+        HeapFree(GetProcessHeap(), 0, data[i]);
+    }
+    IStorage_Release(stg);
+
+    DeleteFileA(filenameA);
+}
+
 static void test_custom_lockbytes(void)
 {
     static const WCHAR stmname[] = { 'C','O','N','T','E','N','T','S',0 };
@@ -3967,5 +4079,6 @@ START_TEST(storage32)
     test_locking();
     test_transacted_shared();
     test_overwrite();
+    test_random_access();
     test_custom_lockbytes();
 }
@@ -5234,6 +5234,67 @@ static void test_LoadTypeLib(void)
     ok(tl == (void *)0xdeadbeef, "Got %p.\n", tl);
 }
 
+static void save_named_typelib(const WCHAR *filename, const WCHAR *name)
+{
+    ICreateTypeLib2 *ctl;
+    HRESULT hr;
+
+    hr = CreateTypeLib2(SYS_WIN32, filename, &ctl);
+    ok(hr == S_OK, "got %08x\n", hr);
+
+    hr = ICreateTypeLib2_SetName(ctl, (LPOLESTR)name);
+    ok(hr == S_OK, "got %08x\n", hr);
+
+    hr = ICreateTypeLib2_SaveAllChanges(ctl);
+    ok(hr == S_OK, "got %08x\n", hr);
+
+    ICreateTypeLib2_Release(ctl);
+}
+
+static void test_LoadTypeLib_file_changed(void)
+{
+    CHAR filenameA[MAX_PATH];
+    WCHAR filenameW[MAX_PATH];
+    ITypeLib *tl;
+    HRESULT hr;
+    BSTR name;
+    ULONG ref;
+
+    GetTempFileNameA(".", "tlb", 0, filenameA);
+    MultiByteToWideChar(CP_ACP, 0, filenameA, -1, filenameW, MAX_PATH);
+
+    save_named_typelib(filenameW, L"first");
+
+    hr = LoadTypeLibEx(filenameW, REGKIND_NONE, &tl);
+    ok(hr == S_OK, "got %08x\n", hr);
+    ref = ITypeLib_Release(tl);
+    ok(!ref, "got %u\n", ref);
+
+    /* loading it again after the last release */
+    hr = LoadTypeLibEx(filenameW, REGKIND_NONE, &tl);
+    ok(hr == S_OK, "got %08x\n", hr);
+    hr = ITypeLib_GetDocumentation(tl, -1, &name, NULL, NULL, NULL);
+    ok(hr == S_OK, "got %08x\n", hr);
+    ok(!lstrcmpW(name, L"first"), "got %s\n", wine_dbgstr_w(name));
+    SysFreeString(name);
+    ref = ITypeLib_Release(tl);
+    ok(!ref, "got %u\n", ref);
+
+    /* the file is rewritten after the typelib was released */
+    save_named_typelib(filenameW, L"second_typelib");
+
+    hr = LoadTypeLibEx(filenameW, REGKIND_NONE, &tl);
+    ok(hr == S_OK, "got %08x\n", hr);
+    hr = ITypeLib_GetDocumentation(tl, -1, &name, NULL, NULL, NULL);
+    ok(hr == S_OK, "got %08x\n", hr);
+    ok(!lstrcmpW(name, L"second_typelib"), "got %s\n", wine_dbgstr_w(name));
+    SysFreeString(name);
+    ref = ITypeLib_Release(tl);
+    ok(!ref, "got %u\n", ref);
+
+    DeleteFileA(filenameA);
+}
+
 static void test_SetVarHelpContext(void)
 {
     static OLECHAR nameW[] = {'n','a','m','e',0};
@@ -6641,6 +6702,7 @@ START_TEST(typelib)
     test_register_typelib(FALSE);
     test_create_typelibs();
     test_LoadTypeLib();
+    test_LoadTypeLib_file_changed();
     test_TypeInfo2_GetContainingTypeLib();
     test_LoadRegTypeLib();
     test_GetLibAttr();
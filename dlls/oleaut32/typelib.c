@@ -1137,14 +1137,19 @@ typedef struct tagITypeLibImpl
 
     /* typelibs are cached, keyed by path and index, so store the linked list info within them */
     struct list entry;
+    struct list released_entry; /* entry in the list of released typelibs kept in the cache */
     WCHAR *path;
     INT index;
+    FILETIME write_time;        /* last write time of the file when the typelib was read */
+    LARGE_INTEGER file_size;
 } ITypeLibImpl;
 
 static const ITypeLib2Vtbl tlbvt;
 static const ITypeCompVtbl tlbtcvt;
 static const ICreateTypeLib2Vtbl CreateTypeLib2Vtbl;
 
+static void ITypeLibImpl_Destroy(ITypeLibImpl *This);
+
 static inline ITypeLibImpl *impl_from_ITypeLib2(ITypeLib2 *iface)
 {
     return CONTAINING_RECORD(iface, ITypeLibImpl, ITypeLib2_iface);
@@ -2874,6 +2879,54 @@ static CRITICAL_SECTION_DEBUG cache_section_debug =
 };
 static CRITICAL_SECTION cache_section = { &cache_section_debug, -1, 0, 0, 0, 0 };
 
+/* When the last reference to a cached typelib goes away it is not destroyed right
+ * away but kept in the cache, so that apps loading and releasing the same typelibs
+ * over and over don't have to parse them every time. Only the most recently
+ * released ones are kept, they are thrown away as soon as the file changes.
+ */
+#define TLB_CACHE_MAX_RELEASED 16
+static struct list tlb_released = LIST_INIT(tlb_released);
+static unsigned int tlb_released_count;
+
+static void TLB_cache_remove_released(ITypeLibImpl *entry)
+{
+    list_remove(&entry->released_entry);
+    list_init(&entry->released_entry);
+    tlb_released_count--;
+}
+
+static void TLB_cache_release(ITypeLibImpl *This)
+{
+    ITypeLibImpl *evict = NULL;
+
+    EnterCriticalSection(&cache_section);
+    if (This->ref || !list_empty(&This->released_entry))
+    {
+        /* revived by a cache lookup in the meantime, or already released again */
+        LeaveCriticalSection(&cache_section);
+        return;
+    }
+    if (list_empty(&This->entry))
+    {
+        /* the file has changed, it can't be picked up from the cache anymore */
+        evict = This;
+    }
+    else
+    {
+        TRACE("keeping %p in cache\n", This);
+        list_add_head(&tlb_released, &This->released_entry);
+        if (++tlb_released_count > TLB_CACHE_MAX_RELEASED)
+        {
+            evict = LIST_ENTRY(list_tail(&tlb_released), ITypeLibImpl, released_entry);
+            TLB_cache_remove_released(evict);
+            list_remove(&evict->entry);
+        }
+    }
+    LeaveCriticalSection(&cache_section);
+
+    if (evict) ITypeLibImpl_Destroy(evict);
+}
+
 
 typedef struct TLB_PEFile
 {
@@ -3307,6 +3360,9 @@ static HRESULT TLB_ReadTypeLib(LPCWSTR pszFileName, LPWSTR pszPath, UINT cchPath
     LPVOID pBase = NULL;
     DWORD dwTLBLength = 0;
     IUnknown *pFile = NULL;
+    ITypeLibImpl *stale = NULL;
+    FILETIME write_time = { 0 };
+    LARGE_INTEGER file_size = { {0} };
     HANDLE h;
 
     *ppTypeLib = NULL;
@@ -3345,6 +3401,8 @@ static HRESULT TLB_ReadTypeLib(LPCWSTR pszFileName, LPWSTR pszPath, UINT cchPath
     h = CreateFileW(pszPath, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
     if(h != INVALID_HANDLE_VALUE){
         GetFinalPathNameByHandleW(h, pszPath, cchPath, FILE_NAME_NORMALIZED | VOLUME_NAME_DOS);
+        GetFileTime(h, NULL, NULL, &write_time);
+        GetFileSizeEx(h, &file_size);
         CloseHandle(h);
     }
 
@@ -3356,7 +3414,22 @@ static HRESULT TLB_ReadTypeLib(LPCWSTR pszFileName, LPWSTR pszPath, UINT cchPath
     {
         if (!wcsicmp(entry->path, pszPath) && entry->index == index)
         {
+            if (CompareFileTime(&entry->write_time, &write_time) ||
+                entry->file_size.QuadPart != file_size.QuadPart)
+            {
+                TRACE("file has changed, dropping %p from cache\n", entry);
+                list_remove(&entry->entry);
+                list_init(&entry->entry);
+                if (!list_empty(&entry->released_entry))
+                {
+                    TLB_cache_remove_released(entry);
+                    stale = entry;
+                }
+                break;
+            }
             TRACE("cache hit\n");
+            if (!list_empty(&entry->released_entry))
+                TLB_cache_remove_released(entry);
             *ppTypeLib = &entry->ITypeLib2_iface;
             ITypeLib2_AddRef(*ppTypeLib);
             LeaveCriticalSection(&cache_section);
@@ -3365,6 +3438,8 @@ static HRESULT TLB_ReadTypeLib(LPCWSTR pszFileName, LPWSTR pszPath, UINT cchPath
     }
     LeaveCriticalSection(&cache_section);
 
+    if (stale) ITypeLibImpl_Destroy(stale);
+
     /* now actually load and parse the typelib */
 
     ret = TLB_PEFile_Open(pszPath, index, &pBase, &dwTLBLength, &pFile);
@@ -3400,6 +3475,8 @@ static HRESULT TLB_ReadTypeLib(LPCWSTR pszFileName, LPWSTR pszPath, UINT cchPath
 	lstrcpyW(impl->path, pszPath);
 	/* We should really canonicalise the path here. */
         impl->index = index;
+        impl->write_time = write_time;
+        impl->file_size = file_size;
 
         /* FIXME: check if it has added already in the meantime */
         EnterCriticalSection(&cache_section);
@@ -3439,6 +3516,8 @@ static ITypeLibImpl* TypeLibImpl_Constructor(void)
     list_init(&pTypeLibImpl->string_list);
     list_init(&pTypeLibImpl->guid_list);
     list_init(&pTypeLibImpl->ref_list);
+    list_init(&pTypeLibImpl->entry);
+    list_init(&pTypeLibImpl->released_entry);
     pTypeLibImpl->dispatch_href = -1;
 
     return pTypeLibImpl;
@@ -4724,81 +4803,80 @@ static ULONG WINAPI ITypeLib2_fnAddRef( ITypeLib2 *iface)
     return ref;
 }
 
-static ULONG WINAPI ITypeLib2_fnRelease( ITypeLib2 *iface)
+static void ITypeLibImpl_Destroy(ITypeLibImpl *This)
 {
-    ITypeLibImpl *This = impl_from_ITypeLib2(iface);
-    ULONG ref = InterlockedDecrement(&This->ref);
+    TLBImpLib *pImpLib, *pImpLibNext;
+    TLBRefType *ref_type, *ref_type_next;
+    TLBString *tlbstr, *tlbstr_next;
+    TLBGuid *tlbguid, *tlbguid_next;
+    int i;
 
-    TRACE("(%p) ref=%u\n",This, ref);
+    TRACE(" destroying ITypeLib(%p)\n",This);
 
-    if (!ref)
-    {
-      TLBImpLib *pImpLib, *pImpLibNext;
-      TLBRefType *ref_type, *ref_type_next;
-      TLBString *tlbstr, *tlbstr_next;
-      TLBGuid *tlbguid, *tlbguid_next;
-      int i;
+    heap_free(This->path);
 
-      /* remove cache entry */
-      if(This->path)
-      {
-          TRACE("removing from cache list\n");
-          EnterCriticalSection(&cache_section);
-          if(This->entry.next)
-              list_remove(&This->entry);
-          LeaveCriticalSection(&cache_section);
-          heap_free(This->path);
-      }
-      TRACE(" destroying ITypeLib(%p)\n",This);
+    LIST_FOR_EACH_ENTRY_SAFE(tlbstr, tlbstr_next, &This->string_list, TLBString, entry) {
+        list_remove(&tlbstr->entry);
+        SysFreeString(tlbstr->str);
+        heap_free(tlbstr);
+    }
 
-      LIST_FOR_EACH_ENTRY_SAFE(tlbstr, tlbstr_next, &This->string_list, TLBString, entry) {
-          list_remove(&tlbstr->entry);
-          SysFreeString(tlbstr->str);
-          heap_free(tlbstr);
-      }
+    LIST_FOR_EACH_ENTRY_SAFE(tlbstr, tlbstr_next, &This->name_list, TLBString, entry) {
+        list_remove(&tlbstr->entry);
+        SysFreeString(tlbstr->str);
+        heap_free(tlbstr);
+    }
 
-      LIST_FOR_EACH_ENTRY_SAFE(tlbstr, tlbstr_next, &This->name_list, TLBString, entry) {
-          list_remove(&tlbstr->entry);
-          SysFreeString(tlbstr->str);
-          heap_free(tlbstr);
-      }
+    LIST_FOR_EACH_ENTRY_SAFE(tlbguid, tlbguid_next, &This->guid_list, TLBGuid, entry) {
+        list_remove(&tlbguid->entry);
+        heap_free(tlbguid);
+    }
 
-      LIST_FOR_EACH_ENTRY_SAFE(tlbguid, tlbguid_next, &This->guid_list, TLBGuid, entry) {
-          list_remove(&tlbguid->entry);
-          heap_free(tlbguid);
-      }
+    TLB_FreeCustData(&This->custdata_list);
 
-      TLB_FreeCustData(&This->custdata_list);
+    for (i = 0; i < This->ctTypeDesc; i++)
+        if (This->pTypeDesc[i].vt == VT_CARRAY)
+            heap_free(This->pTypeDesc[i].u.lpadesc);
 
-      for (i = 0; i < This->ctTypeDesc; i++)
-          if (This->pTypeDesc[i].vt == VT_CARRAY)
-              heap_free(This->pTypeDesc[i].u.lpadesc);
+    heap_free(This->pTypeDesc);
 
-      heap_free(This->pTypeDesc);
+    LIST_FOR_EACH_ENTRY_SAFE(pImpLib, pImpLibNext, &This->implib_list, TLBImpLib, entry)
+    {
+        if (pImpLib->pImpTypeLib)
+            ITypeLib2_Release(&pImpLib->pImpTypeLib->ITypeLib2_iface);
+        SysFreeString(pImpLib->name);
 
-      LIST_FOR_EACH_ENTRY_SAFE(pImpLib, pImpLibNext, &This->implib_list, TLBImpLib, entry)
-      {
-          if (pImpLib->pImpTypeLib)
-              ITypeLib2_Release(&pImpLib->pImpTypeLib->ITypeLib2_iface);
-          SysFreeString(pImpLib->name);
+        list_remove(&pImpLib->entry);
+        heap_free(pImpLib);
+    }
 
-          list_remove(&pImpLib->entry);
-          heap_free(pImpLib);
-      }
+    LIST_FOR_EACH_ENTRY_SAFE(ref_type, ref_type_next, &This->ref_list, TLBRefType, entry)
+    {
+        list_remove(&ref_type->entry);
+        heap_free(ref_type);
+    }
 
-      LIST_FOR_EACH_ENTRY_SAFE(ref_type, ref_type_next, &This->ref_list, TLBRefType, entry)
-      {
-          list_remove(&ref_type->entry);
-          heap_free(ref_type);
-      }
+    for (i = 0; i < This->TypeInfoCount; ++i){
+        heap_free(This->typeinfos[i]->tdescAlias);
+        ITypeInfoImpl_Destroy(This->typeinfos[i]);
+    }
+    heap_free(This->typeinfos);
+    heap_free(This);
+}
 
-      for (i = 0; i < This->TypeInfoCount; ++i){
-          heap_free(This->typeinfos[i]->tdescAlias);
-          ITypeInfoImpl_Destroy(This->typeinfos[i]);
-      }
-      heap_free(This->typeinfos);
-      heap_free(This);
-      return 0;
+static ULONG WINAPI ITypeLib2_fnRelease( ITypeLib2 *iface)
+{
+    ITypeLibImpl *This = impl_from_ITypeLib2(iface);
+    ULONG ref = InterlockedDecrement(&This->ref);
+
+    TRACE("(%p) ref=%u\n",This, ref);
+
+    if (!ref)
+    {
+        if (This->path)
+            TLB_cache_release(This);
+        else
+            ITypeLibImpl_Destroy(This);
     }
 
     return ref;
@@ -535,6 +535,37 @@ void client_do_args( PMIDL_STUB_MESSAGE pStubMsg, PFORMAT_STRING pFormat, enum s
     }
 }
 
+/* MIDL precomputes the buffer space needed by the parameters whose wire size
+ * doesn't depend on their value, and only flags the others with MustSize. */
+static void client_calc_size( PMIDL_STUB_MESSAGE pStubMsg, PFORMAT_STRING pFormat, void **fpu_args,
+                              unsigned short number_of_params, unsigned char *pRetVal,
+                              const NDR_PROC_PARTIAL_OIF_HEADER *oif_header )
+{
+    const NDR_PARAM_OIF *params = (const NDR_PARAM_OIF *)pFormat;
+    unsigned int i;
+
+    if (!oif_header)
+    {
+        client_do_args( pStubMsg, pFormat, STUBLESS_CALCSIZE, fpu_args, number_of_params, pRetVal );
+        return;
+    }
+
+    pStubMsg->BufferLength += oif_header->constant_client_buffer_size;
+
+    for (i = 0; i < number_of_params; i++)
+    {
+        unsigned char *pArg = pStubMsg->StackTop + params[i].stack_offset;
+
+        if (params[i].attr.IsSimpleRef && !*(unsigned char **)pArg)
+            RpcRaiseException(RPC_X_NULL_REF_POINTER);
+        if (params[i].attr.IsIn && params[i].attr.MustSize)
+        {
+            TRACE("param[%d]: %p %s\n", i, pArg, debugstr_PROC_PF( params[i].attr ));
+            call_buffer_sizer(pStubMsg, pArg, &params[i]);
+        }
+    }
+}
+
 static unsigned int type_stack_size(unsigned char fc)
 {
     switch (fc)
@@ -699,7 +730,8 @@ static void CALLBACK ndr_client_call_finally(BOOL normal, void *arg)
 static LONG_PTR do_ndr_client_call( const MIDL_STUB_DESC *stub_desc, const PFORMAT_STRING format,
         const PFORMAT_STRING handle_format, void **stack_top, void **fpu_stack, MIDL_STUB_MESSAGE *stub_msg,
         unsigned short procedure_number, unsigned short stack_size, unsigned int number_of_params,
-        INTERPRETER_OPT_FLAGS Oif_flags, INTERPRETER_OPT_FLAGS2 ext_flags, const NDR_PROC_HEADER *proc_header )
+        INTERPRETER_OPT_FLAGS Oif_flags, INTERPRETER_OPT_FLAGS2 ext_flags, const NDR_PROC_HEADER *proc_header,
+        const NDR_PROC_PARTIAL_OIF_HEADER *oif_header )
 {
     struct ndr_client_call_ctx finally_ctx;
     RPC_MESSAGE rpc_msg;
@@ -789,8 +821,8 @@ static LONG_PTR do_ndr_client_call( const MIDL_STUB_DESC *stub_desc, const PFORM
 
         /* 2. CALCSIZE */
         TRACE( "CALCSIZE\n" );
-        client_do_args(stub_msg, format, STUBLESS_CALCSIZE, fpu_stack,
-                       number_of_params, (unsigned char *)&retval);
+        client_calc_size(stub_msg, format, fpu_stack, number_of_params,
+                         (unsigned char *)&retval, oif_header);
 
         /* 3. GETBUFFER */
         TRACE( "GETBUFFER\n" );
@@ -864,6 +896,8 @@ LONG_PTR CDECL DECLSPEC_HIDDEN ndr_client_call( PMIDL_STUB_DESC pStubDesc, PFORM
     LONG_PTR RetVal = 0;
     PFORMAT_STRING pHandleFormat;
     NDR_PARAM_OIF old_args[256];
+    /* -Oicf header, NULL for old style format strings */
+    const NDR_PROC_PARTIAL_OIF_HEADER *pOIFHeader = NULL;
 
     TRACE("pStubDesc %p, pFormat %p, ...\n", pStubDesc, pFormat);
 
@@ -895,8 +929,7 @@ LONG_PTR CDECL DECLSPEC_HIDDEN ndr_client_call( PMIDL_STUB_DESC pStubDesc, PFORM
 
     if (is_oicf_stubdesc(pStubDesc))  /* -Oicf format */
     {
-        const NDR_PROC_PARTIAL_OIF_HEADER *pOIFHeader =
-            (const NDR_PROC_PARTIAL_OIF_HEADER *)pFormat;
+        pOIFHeader = (const NDR_PROC_PARTIAL_OIF_HEADER *)pFormat;
 
         Oif_flags = pOIFHeader->Oi2Flags;
         number_of_params = pOIFHeader->number_of_params;
@@ -938,7 +971,7 @@ LONG_PTR CDECL DECLSPEC_HIDDEN ndr_client_call( PMIDL_STUB_DESC pStubDesc, PFORM
         {
             RetVal = do_ndr_client_call(pStubDesc, pFormat, pHandleFormat,
                     stack_top, fpu_stack, &stubMsg, procedure_number, stack_size,
-                    number_of_params, Oif_flags, ext_flags, pProcHeader);
+                    number_of_params, Oif_flags, ext_flags, pProcHeader, pOIFHeader);
         }
         __EXCEPT_ALL
         {
@@ -956,7 +989,7 @@ LONG_PTR CDECL DECLSPEC_HIDDEN ndr_client_call( PMIDL_STUB_DESC pStubDesc, PFORM
         {
             RetVal = do_ndr_client_call(pStubDesc, pFormat, pHandleFormat,
                     stack_top, fpu_stack, &stubMsg, procedure_number, stack_size,
-                    number_of_params, Oif_flags, ext_flags, pProcHeader);
+                    number_of_params, Oif_flags, ext_flags, pProcHeader, pOIFHeader);
         }
         __EXCEPT_ALL
         {
@@ -989,7 +1022,7 @@ LONG_PTR CDECL DECLSPEC_HIDDEN ndr_client_call( PMIDL_STUB_DESC pStubDesc, PFORM
     {
         RetVal = do_ndr_client_call(pStubDesc, pFormat, pHandleFormat,
                 stack_top, fpu_stack, &stubMsg, procedure_number, stack_size,
-                number_of_params, Oif_flags, ext_flags, pProcHeader);
+                number_of_params, Oif_flags, ext_flags, pProcHeader, pOIFHeader);
     }
 
     TRACE("RetVal = 0x%lx\n", RetVal);
@@ -1289,6 +1322,36 @@ static LONG_PTR *stub_do_args(MIDL_STUB_MESSAGE *pStubMsg,
     return retval_ptr;
 }
 
+/* see client_calc_size() */
+static void stub_calc_size(MIDL_STUB_MESSAGE *pStubMsg, PFORMAT_STRING pFormat,
+                           unsigned short number_of_params,
+                           const NDR_PROC_PARTIAL_OIF_HEADER *oif_header)
+{
+    const NDR_PARAM_OIF *params = (const NDR_PARAM_OIF *)pFormat;
+    unsigned int i;
+
+    if (!oif_header)
+    {
+        stub_do_args(pStubMsg, pFormat, STUBLESS_CALCSIZE, number_of_params);
+        return;
+    }
+
+    pStubMsg->BufferLength += oif_header->constant_server_buffer_size;
+    if (!oif_header->Oi2Flags.ServerMustSize) return;
+
+    for (i = 0; i < number_of_params; i++)
+    {
+        unsigned char *pArg = pStubMsg->StackTop + params[i].stack_offset;
+
+        if ((params[i].attr.IsOut || params[i].attr.IsReturn) && params[i].attr.MustSize)
+        {
+            TRACE("param[%d]: %p -> %p %s\n", i, pArg, *(unsigned char **)pArg,
+                  debugstr_PROC_PF( params[i].attr ));
+            call_buffer_sizer(pStubMsg, pArg, &params[i]);
+        }
+    }
+}
+
 /***********************************************************************
  *            NdrStubCall2 [RPCRT4.@]
  *
@@ -1316,6 +1379,8 @@ LONG WINAPI NdrStubCall2(
     unsigned int number_of_params;
     /* cache of Oif_flags from v2 procedure header */
     INTERPRETER_OPT_FLAGS Oif_flags = { 0 };
+    /* -Oicf header, NULL for old style format strings */
+    const NDR_PROC_PARTIAL_OIF_HEADER *pOIFHeader = NULL;
     /* cache of extension flags from NDR_PROC_HEADER_EXTS */
     INTERPRETER_OPT_FLAGS2 ext_flags = { 0 };
     /* the type of pass we are currently doing */
@@ -1419,7 +1484,7 @@ LONG WINAPI NdrStubCall2(
 
     if (is_oicf_stubdesc(pStubDesc))
     {
-        const NDR_PROC_PARTIAL_OIF_HEADER *pOIFHeader = (const NDR_PROC_PARTIAL_OIF_HEADER *)pFormat;
+        pOIFHeader = (const NDR_PROC_PARTIAL_OIF_HEADER *)pFormat;
 
         Oif_flags = pOIFHeader->Oi2Flags;
         number_of_params = pOIFHeader->number_of_params;
@@ -1516,9 +1581,11 @@ LONG WINAPI NdrStubCall2(
                 stubMsg.Buffer = pRpcMsg->Buffer;
             }
             break;
+        case STUBLESS_CALCSIZE:
+            stub_calc_size(&stubMsg, pFormat, number_of_params, pOIFHeader);
+            break;
         case STUBLESS_UNMARSHAL:
         case STUBLESS_INITOUT:
-        case STUBLESS_CALCSIZE:
         case STUBLESS_MARSHAL:
         case STUBLESS_MUSTFREE:
         case STUBLESS_FREE:
@@ -30,6 +30,13 @@
 
 #include "tomcrypt.h"
 
+#if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__)) && \
+    (defined(__clang__) || __GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))
+#define USE_AESNI
+#include "windef.h"
+#include "winbase.h"
+#endif
+
 static const ulong32 TE0[256] = {
     0xc66363a5UL, 0xf87c7c84UL, 0xee777799UL, 0xf67b7b8dUL,
     0xfff2f20dUL, 0xd66b6bbdUL, 0xde6f6fb1UL, 0x91c5c554UL,
@@ -934,6 +941,145 @@ static ulong32 setup_mix(ulong32 temp)
           (Te4_0[byte(temp, 3)]);
 }
 
+#ifdef USE_AESNI
+
+/* The AES-NI kernels only use compiler builtins, so that no compiler
+ * specific headers are needed when building against msvcrt. */
+typedef long long aesni_block __attribute__((vector_size(16)));
+
+static void aesni_cpuid(unsigned int ax, unsigned int *p)
+{
+#ifdef __i386__
+    __asm__ __volatile__("xchgl %%ebx,%1\n\tcpuid\n\txchgl %%ebx,%1"
+                         : "=a"(p[0]), "=r"(p[1]), "=c"(p[2]), "=d"(p[3]) : "a"(ax), "c"(0));
+#else
+    __asm__ __volatile__("cpuid" : "=a"(p[0]), "=b"(p[1]), "=c"(p[2]), "=d"(p[3]) : "a"(ax), "c"(0));
+#endif
+}
+
+static int aesni_supported(void)
+{
+    static int supported = -1;
+    unsigned int regs[4];
+
+    if (supported == -1) {
+        /* any CPU with SSE2 also supports cpuid */
+        supported = 0;
+        if (IsProcessorFeaturePresent(PF_XMMI64_INSTRUCTIONS_AVAILABLE)) {
+            aesni_cpuid(1, regs);
+            supported = (regs[2] >> 25) & 1;
+        }
+    }
+    return supported;
+}
+
+#define AESNI_FUNC __attribute__((target("aes,sse2")))
+
+static inline AESNI_FUNC aesni_block aesni_load(const unsigned char *p)
+{
+    aesni_block b;
+    memcpy(&b, p, sizeof(b));
+    return b;
+}
+
+static inline AESNI_FUNC void aesni_store(unsigned char *p, aesni_block b)
+{
+    memcpy(p, &b, sizeof(b));
+}
+
+static AESNI_FUNC void aesni_ecb_encrypt(const unsigned char *pt, unsigned char *ct, const aes_key *skey)
+{
+    const unsigned char *rk = skey->ni_eK;
+    aesni_block b;
+    int r;
+
+    b = aesni_load(pt) ^ aesni_load(rk);
+    for (r = 1; r < skey->Nr; r++) b = __builtin_ia32_aesenc128(b, aesni_load(rk + 16 * r));
+    b = __builtin_ia32_aesenclast128(b, aesni_load(rk + 16 * skey->Nr));
+    aesni_store(ct, b);
+}
+
+static AESNI_FUNC void aesni_ecb_decrypt(const unsigned char *ct, unsigned char *pt, const aes_key *skey)
+{
+    const unsigned char *rk = skey->ni_dK;
+    aesni_block b;
+    int r;
+
+    b = aesni_load(ct) ^ aesni_load(rk);
+    for (r = 1; r < skey->Nr; r++) b = __builtin_ia32_aesdec128(b, aesni_load(rk + 16 * r));
+    b = __builtin_ia32_aesdeclast128(b, aesni_load(rk + 16 * skey->Nr));
+    aesni_store(pt, b);
+}
+
+static AESNI_FUNC void aesni_cbc_encrypt(const unsigned char *pt, unsigned char *ct, unsigned long blocks,
+                                         unsigned char *iv, const aes_key *skey)
+{
+    const unsigned char *rk = skey->ni_eK;
+    aesni_block b = aesni_load(iv);
+    int r;
+
+    for (; blocks; blocks--, pt += 16, ct += 16) {
+        b ^= aesni_load(pt);
+        b ^= aesni_load(rk);
+        for (r = 1; r < skey->Nr; r++) b = __builtin_ia32_aesenc128(b, aesni_load(rk + 16 * r));
+        b = __builtin_ia32_aesenclast128(b, aesni_load(rk + 16 * skey->Nr));
+        aesni_store(ct, b);
+    }
+    aesni_store(iv, b);
+}
+
+/* CBC decryption has no dependency between blocks, so interleave four of
+ * them to keep the AES unit busy */
+static AESNI_FUNC void aesni_cbc_decrypt(const unsigned char *ct, unsigned char *pt, unsigned long blocks,
+                                         unsigned char *iv, const aes_key *skey)
+{
+    const unsigned char *rk = skey->ni_dK;
+    aesni_block prev = aesni_load(iv);
+    aesni_block c0, c1, c2, c3, b0, b1, b2, b3, k;
+    int r;
+
+    for (; blocks >= 4; blocks -= 4, ct += 64, pt += 64) {
+        c0 = aesni_load(ct);
+        c1 = aesni_load(ct + 16);
+        c2 = aesni_load(ct + 32);
+        c3 = aesni_load(ct + 48);
+        k = aesni_load(rk);
+        b0 = c0 ^ k;
+        b1 = c1 ^ k;
+        b2 = c2 ^ k;
+        b3 = c3 ^ k;
+        for (r = 1; r < skey->Nr; r++) {
+            k = aesni_load(rk + 16 * r);
+            b0 = __builtin_ia32_aesdec128(b0, k);
+            b1 = __builtin_ia32_aesdec128(b1, k);
+            b2 = __builtin_ia32_aesdec128(b2, k);
+            b3 = __builtin_ia32_aesdec128(b3, k);
+        }
+        k = aesni_load(rk + 16 * skey->Nr);
+        b0 = __builtin_ia32_aesdeclast128(b0, k) ^ prev;
+        b1 = __builtin_ia32_aesdeclast128(b1, k) ^ c0;
+        b2 = __builtin_ia32_aesdeclast128(b2, k) ^ c1;
+        b3 = __builtin_ia32_aesdeclast128(b3, k) ^ c2;
+        aesni_store(pt, b0);
+        aesni_store(pt + 16, b1);
+        aesni_store(pt + 32, b2);
+        aesni_store(pt + 48, b3);
+        prev = c3;
+    }
+
+    for (; blocks; blocks--, ct += 16, pt += 16) {
+        c0 = aesni_load(ct);
+        b0 = c0 ^ aesni_load(rk);
+        for (r = 1; r < skey->Nr; r++) b0 = __builtin_ia32_aesdec128(b0, aesni_load(rk + 16 * r));
+        b0 = __builtin_ia32_aesdeclast128(b0, aesni_load(rk + 16 * skey->Nr));
+        aesni_store(pt, b0 ^ prev);
+        prev = c0;
+    }
+    aesni_store(iv, prev);
+}
+
+#endif /* USE_AESNI */
+
 int aes_setup(const unsigned char *key, int keylen, int rounds, aes_key *skey)
 {
     int i, j;
@@ -1058,6 +1204,19 @@ int aes_setup(const unsigned char *key, int keylen, int rounds, aes_key *skey)
     *rk++ = *rrk++;
     *rk   = *rrk;
 
+    skey->use_aesni = 0;
+#ifdef USE_AESNI
+    if (aesni_supported()) {
+        /* AES-NI wants the round keys as byte strings; the decryption keys
+         * already have InvMixColumns applied, as AESDEC expects */
+        for (i = 0; i < 4 * (skey->Nr + 1); i++) {
+            STORE32H(skey->eK[i], skey->ni_eK + 4 * i);
+            STORE32H(skey->dK[i], skey->ni_dK + 4 * i);
+        }
+        skey->use_aesni = 1;
+    }
+#endif
+
     return CRYPT_OK;
 }
 
@@ -1066,6 +1225,13 @@ void aes_ecb_encrypt(const unsigned char *pt, unsigned char *ct, aes_key *skey)
     ulong32 s0, s1, s2, s3, t0, t1, t2, t3, *rk;
     int Nr, r;
 
+#ifdef USE_AESNI
+    if (skey->use_aesni) {
+        aesni_ecb_encrypt(pt, ct, skey);
+        return;
+    }
+#endif
+
     Nr = skey->Nr;
     rk = skey->eK;
 
@@ -1167,6 +1333,13 @@ void aes_ecb_decrypt(const unsigned char *ct, unsigned char *pt, aes_key *skey)
     ulong32 s0, s1, s2, s3, t0, t1, t2, t3, *rk;
     int Nr, r;
 
+#ifdef USE_AESNI
+    if (skey->use_aesni) {
+        aesni_ecb_decrypt(ct, pt, skey);
+        return;
+    }
+#endif
+
     Nr = skey->Nr;
     rk = skey->dK;
 
@@ -1264,3 +1437,43 @@ void aes_ecb_decrypt(const unsigned char *ct, unsigned char *pt, aes_key *skey)
         rk[3];
     STORE32H(s3, pt+12);
 }
+
+void aes_cbc_encrypt(const unsigned char *pt, unsigned char *ct, unsigned long blocks,
+                     unsigned char *iv, aes_key *skey)
+{
+    int i;
+
+#ifdef USE_AESNI
+    if (skey->use_aesni) {
+        aesni_cbc_encrypt(pt, ct, blocks, iv, skey);
+        return;
+    }
+#endif
+
+    for (; blocks; blocks--, pt += 16, ct += 16) {
+        for (i = 0; i < 16; i++) iv[i] ^= pt[i];
+        aes_ecb_encrypt(iv, iv, skey);
+        memcpy(ct, iv, 16);
+    }
+}
+
+void aes_cbc_decrypt(const unsigned char *ct, unsigned char *pt, unsigned long blocks,
+                     unsigned char *iv, aes_key *skey)
+{
+    unsigned char tmp[16];
+    int i;
+
+#ifdef USE_AESNI
+    if (skey->use_aesni) {
+        aesni_cbc_decrypt(ct, pt, blocks, iv, skey);
+        return;
+    }
+#endif
+
+    for (; blocks; blocks--, ct += 16, pt += 16) {
+        aes_ecb_decrypt(ct, tmp, skey);
+        for (i = 0; i < 16; i++) tmp[i] ^= iv[i];
+        memcpy(iv, ct, 16);
+        memcpy(pt, tmp, 16);
+    }
+}
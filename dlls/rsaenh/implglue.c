@@ -297,6 +297,28 @@ BOOL encrypt_block_impl(ALG_ID aiAlgid, DWORD dwKeySpec, KEY_CONTEXT *pKeyContex
     return TRUE;
 }
 
+/* Process a whole buffer of blocks in CBC mode at once. Returns FALSE if the
+ * algorithm has no bulk implementation and has to be chained block by block. */
+BOOL encrypt_cbc_impl(ALG_ID aiAlgid, KEY_CONTEXT *pKeyContext, BYTE *pbInOut, DWORD dwLen,
+                      BYTE *pbChainVector, DWORD enc)
+{
+    switch (aiAlgid) {
+        case CALG_AES:
+        case CALG_AES_128:
+        case CALG_AES_192:
+        case CALG_AES_256:
+            if (enc) {
+                aes_cbc_encrypt(pbInOut, pbInOut, dwLen / 16, pbChainVector, &pKeyContext->aes);
+            } else {
+                aes_cbc_decrypt(pbInOut, pbInOut, dwLen / 16, pbChainVector, &pKeyContext->aes);
+            }
+            return TRUE;
+
+        default:
+            return FALSE;
+    }
+}
+
 BOOL encrypt_stream_impl(ALG_ID aiAlgid, KEY_CONTEXT *pKeyContext, BYTE *stream, DWORD dwLen)
 {
     switch (aiAlgid) {
@@ -2532,7 +2532,14 @@ BOOL WINAPI RSAENH_CPEncrypt(HCRYPTPROV hProv, HCRYPTKEY hKey, HCRYPTHASH hHash,
         for (i=*pdwDataLen; i<dwEncryptedLen; i++) pbData[i] = dwEncryptedLen - *pdwDataLen;
         *pdwDataLen = dwEncryptedLen;
 
-        for (i=0, in=pbData; i<*pdwDataLen; i+=pCryptKey->dwBlockLen, in+=pCryptKey->dwBlockLen) {
+        if (pCryptKey->dwMode == CRYPT_MODE_CBC &&
+            encrypt_cbc_impl(pCryptKey->aiAlgid, &pCryptKey->context, pbData, *pdwDataLen,
+                             pCryptKey->abChainVector, RSAENH_ENCRYPT))
+            i = *pdwDataLen;
+        else
+            i = 0;
+
+        for (in=pbData+i; i<*pdwDataLen; i+=pCryptKey->dwBlockLen, in+=pCryptKey->dwBlockLen) {
             switch (pCryptKey->dwMode) {
                 case CRYPT_MODE_ECB:
                     encrypt_block_impl(pCryptKey->aiAlgid, 0, &pCryptKey->context, in, out, 
@@ -2661,7 +2668,14 @@ BOOL WINAPI RSAENH_CPDecrypt(HCRYPTPROV hProv, HCRYPTKEY hKey, HCRYPTHASH hHash,
     dwMax=*pdwDataLen;
 
     if (GET_ALG_TYPE(pCryptKey->aiAlgid) == ALG_TYPE_BLOCK) {
-        for (i=0, in=pbData; i<*pdwDataLen; i+=pCryptKey->dwBlockLen, in+=pCryptKey->dwBlockLen) {
+        if (pCryptKey->dwMode == CRYPT_MODE_CBC && !(*pdwDataLen % pCryptKey->dwBlockLen) &&
+            encrypt_cbc_impl(pCryptKey->aiAlgid, &pCryptKey->context, pbData, *pdwDataLen,
+                             pCryptKey->abChainVector, RSAENH_DECRYPT))
+            i = *pdwDataLen;
+        else
+            i = 0;
+
+        for (in=pbData+i; i<*pdwDataLen; i+=pCryptKey->dwBlockLen, in+=pCryptKey->dwBlockLen) {
             switch (pCryptKey->dwMode) {
                 case CRYPT_MODE_ECB:
                     encrypt_block_impl(pCryptKey->aiAlgid, 0, &pCryptKey->context, in, out, 
@@ -1252,6 +1252,97 @@ static void test_aes(int keylen)
     ok(result, "%08x\n", GetLastError());
 }
 
+static void test_aes_cbc_known_answer(void)
+{
+    /* NIST SP 800-38A, F.2.1 and F.2.5 */
+    static const BYTE iv[16] = {
+        0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f };
+    static const BYTE plain[64] = {
+        0x6b, 0xc1, 0xbe, 0xe2, 0x2e, 0x40, 0x9f, 0x96, 0xe9, 0x3d, 0x7e, 0x11, 0x73, 0x93, 0x17, 0x2a,
+        0xae, 0x2d, 0x8a, 0x57, 0x1e, 0x03, 0xac, 0x9c, 0x9e, 0xb7, 0x6f, 0xac, 0x45, 0xaf, 0x8e, 0x51,
+        0x30, 0xc8, 0x1c, 0x46, 0xa3, 0x5c, 0xe4, 0x11, 0xe5, 0xfb, 0xc1, 0x19, 0x1a, 0x0a, 0x52, 0xef,
+        0xf6, 0x9f, 0x24, 0x45, 0xdf, 0x4f, 0x9b, 0x17, 0xad, 0x2b, 0x41, 0x7b, 0xe6, 0x6c, 0x37, 0x10 };
+    static const struct
+    {
+        ALG_ID algid;
+        DWORD key_len;
+        BYTE key[32];
+        BYTE cipher[64];
+    }
+    tests[] =
+    {
+        {
+            CALG_AES_128, 16,
+            { 0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6, 0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c },
+            { 0x76, 0x49, 0xab, 0xac, 0x81, 0x19, 0xb2, 0x46, 0xce, 0xe9, 0x8e, 0x9b, 0x12, 0xe9, 0x19, 0x7d,
+              0x50, 0x86, 0xcb, 0x9b, 0x50, 0x72, 0x19, 0xee, 0x95, 0xdb, 0x11, 0x3a, 0x91, 0x76, 0x78, 0xb2,
+              0x73, 0xbe, 0xd6, 0xb8, 0xe3, 0xc1, 0x74, 0x3b, 0x71, 0x16, 0xe6, 0x9e, 0x22, 0x22, 0x95, 0x16,
+              0x3f, 0xf1, 0xca, 0xa1, 0x68, 0x1f, 0xac, 0x09, 0x12, 0x0e, 0xca, 0x30, 0x75, 0x86, 0xe1, 0xa7 }
+        },
+        {
+            CALG_AES_256, 32,
+            { 0x60, 0x3d, 0xeb, 0x10, 0x15, 0xca, 0x71, 0xbe, 0x2b, 0x73, 0xae, 0xf0, 0x85, 0x7d, 0x77, 0x81,
+              0x1f, 0x35, 0x2c, 0x07, 0x3b, 0x61, 0x08, 0xd7, 0x2d, 0x98, 0x10, 0xa3, 0x09, 0x14, 0xdf, 0xf4 },
+            { 0xf5, 0x8c, 0x4c, 0x04, 0xd6, 0xe5, 0xf1, 0xba, 0x77, 0x9e, 0xab, 0xfb, 0x5f, 0x7b, 0xfb, 0xd6,
+              0x9c, 0xfc, 0x4e, 0x96, 0x7e, 0xdb, 0x80, 0x8d, 0x67, 0x9f, 0x77, 0x7b, 0xc6, 0x70, 0x2c, 0x7d,
+              0x39, 0xf2, 0x33, 0x69, 0xa9, 0xd9, 0xba, 0xcf, 0xa5, 0x30, 0xe2, 0x63, 0x04, 0x23, 0x14, 0x61,
+              0xb2, 0xeb, 0x05, 0xe2, 0xc3, 0x9b, 0xe9, 0xfc, 0xda, 0x6c, 0x19, 0x07, 0x8c, 0x6a, 0x9d, 0x1b }
+        },
+    };
+    BYTE blob[sizeof(BLOBHEADER) + sizeof(DWORD) + 32], data[64];
+    BLOBHEADER *header = (BLOBHEADER *)blob;
+    DWORD *key_len = (DWORD *)(header + 1);
+    HCRYPTKEY key;
+    DWORD i, len;
+    BOOL result;
+
+    for (i = 0; i < ARRAY_SIZE(tests); i++)
+    {
+        header->bType = PLAINTEXTKEYBLOB;
+        header->bVersion = CUR_BLOB_VERSION;
+        header->reserved = 0;
+        header->aiKeyAlg = tests[i].algid;
+        *key_len = tests[i].key_len;
+        memcpy(key_len + 1, tests[i].key, tests[i].key_len);
+        result = CryptImportKey(hProv, blob, sizeof(BLOBHEADER) + sizeof(DWORD) + tests[i].key_len,
+                                0, 0, &key);
+        ok(result, "%u: CryptImportKey failed: %08x\n", i, GetLastError());
+        if (!result) continue;
+
+        result = CryptSetKeyParam(key, KP_IV, iv, 0);
+        ok(result, "%u: CryptSetKeyParam failed: %08x\n", i, GetLastError());
+        memcpy(data, plain, sizeof(data));
+        len = sizeof(data);
+        result = CryptEncrypt(key, 0, FALSE, 0, data, &len, sizeof(data));
+        ok(result, "%u: CryptEncrypt failed: %08x\n", i, GetLastError());
+        ok(len == sizeof(data), "%u: got length %u\n", i, len);
+        ok(!memcmp(data, tests[i].cipher, sizeof(data)), "%u: wrong cipher text\n", i);
+
+        /* all blocks at once */
+        result = CryptSetKeyParam(key, KP_IV, iv, 0);
+        ok(result, "%u: CryptSetKeyParam failed: %08x\n", i, GetLastError());
+        len = sizeof(data);
+        result = CryptDecrypt(key, 0, FALSE, 0, data, &len);
+        ok(result, "%u: CryptDecrypt failed: %08x\n", i, GetLastError());
+        ok(len == sizeof(data), "%u: got length %u\n", i, len);
+        ok(!memcmp(data, plain, sizeof(data)), "%u: wrong plain text\n", i);
+
+        /* chaining across calls */
+        result = CryptSetKeyParam(key, KP_IV, iv, 0);
+        ok(result, "%u: CryptSetKeyParam failed: %08x\n", i, GetLastError());
+        memcpy(data, tests[i].cipher, sizeof(data));
+        len = 48;
+        result = CryptDecrypt(key, 0, FALSE, 0, data, &len);
+        ok(result, "%u: CryptDecrypt failed: %08x\n", i, GetLastError());
+        len = 16;
+        result = CryptDecrypt(key, 0, FALSE, 0, data + 48, &len);
+        ok(result, "%u: CryptDecrypt failed: %08x\n", i, GetLastError());
+        ok(!memcmp(data, plain, sizeof(data)), "%u: wrong plain text\n", i);
+
+        CryptDestroyKey(key);
+    }
+}
+
 static void test_sha2(void)
 {
     static const unsigned char sha256hash[32] = {
@@ -3978,6 +4069,7 @@ START_TEST(rsaenh)
     test_aes(128);
     test_aes(192);
     test_aes(256);
+    test_aes_cbc_known_answer();
     test_sha2();
     test_key_derivation("AES");
     clean_up_aes_environment();
@@ -132,6 +132,8 @@ typedef struct tag_des3_key {
 typedef struct tag_aes_key {
    ulong32 eK[64], dK[64];
    int Nr;
+   int use_aesni;
+   unsigned char ni_eK[15 * 16], ni_dK[15 * 16];
 } aes_key;
 
 int rc2_setup(const unsigned char *key, int keylen, int bits, int num_rounds, rc2_key *skey);
@@ -149,6 +151,10 @@ void des3_ecb_decrypt(const unsigned char *ct, unsigned char *pt, const des3_key
 int aes_setup(const unsigned char *key, int keylen, int rounds, aes_key *skey);
 void aes_ecb_encrypt(const unsigned char *pt, unsigned char *ct, aes_key *skey);
 void aes_ecb_decrypt(const unsigned char *ct, unsigned char *pt, aes_key *skey);
+void aes_cbc_encrypt(const unsigned char *pt, unsigned char *ct, unsigned long blocks,
+                     unsigned char *iv, aes_key *skey);
+void aes_cbc_decrypt(const unsigned char *ct, unsigned char *pt, unsigned long blocks,
+                     unsigned char *iv, aes_key *skey);
 
 struct rc4_prng {
     int x, y;
@@ -122,6 +122,7 @@ enum system_queue_index
 
 struct work_item
 {
+    SLIST_ENTRY free_entry;
     IUnknown IUnknown_iface;
     LONG refcount;
     struct list entry;
@@ -139,6 +140,10 @@ struct work_item
     } u;
 };
 
+/* Released work items are kept for reuse, submitting is frequent and items are small. */
+#define MAX_FREE_WORK_ITEMS 256
+static SLIST_HEADER free_work_items;
+
 static struct work_item *work_item_impl_from_IUnknown(IUnknown *iface)
 {
     return CONTAINING_RECORD(iface, struct work_item, IUnknown_iface);
@@ -158,7 +163,7 @@ struct queue_ops
 {
     HRESULT (*init)(const struct queue_desc *desc, struct queue *queue);
     BOOL (*shutdown)(struct queue *queue);
-    void (*submit)(struct queue *queue, struct work_item *item);
+    HRESULT (*submit)(struct queue *queue, struct work_item *item);
 };
 
 struct queue_desc
@@ -353,7 +358,7 @@ static BOOL pool_queue_shutdown(struct queue *queue)
     return TRUE;
 }
 
-static void CALLBACK standard_queue_worker(TP_CALLBACK_INSTANCE *instance, void *context, TP_WORK *work)
+static void CALLBACK standard_queue_worker(TP_CALLBACK_INSTANCE *instance, void *context)
 {
     struct work_item *item = context;
     RTWQASYNCRESULT *result = (RTWQASYNCRESULT *)item->result;
@@ -369,11 +374,10 @@ static void CALLBACK standard_queue_worker(TP_CALLBACK_INSTANCE *instance, void
     IUnknown_Release(&item->IUnknown_iface);
 }
 
-static void pool_queue_submit(struct queue *queue, struct work_item *item)
+static HRESULT pool_queue_submit(struct queue *queue, struct work_item *item)
 {
     TP_CALLBACK_PRIORITY callback_priority;
     TP_CALLBACK_ENVIRON_V3 env;
-    TP_WORK *work_object;
 
     if (item->priority == 0)
         callback_priority = TP_CALLBACK_PRIORITY_NORMAL;
@@ -388,10 +392,22 @@ static void pool_queue_submit(struct queue *queue, struct work_item *item)
        we need finalization callback. */
     if (item->finalization_callback)
         IUnknown_AddRef(&item->IUnknown_iface);
-    work_object = CreateThreadpoolWork(standard_queue_worker, item, (TP_CALLBACK_ENVIRON *)&env);
-    SubmitThreadpoolWork(work_object);
+    /* Simple callbacks are freed once they have run, unlike work objects that would stay
+       in the cleanup group until the queue is shut down. */
+    if (!TrySubmitThreadpoolCallback(standard_queue_worker, item, (TP_CALLBACK_ENVIRON *)&env))
+    {
+        DWORD error = GetLastError();
+
+        WARN("Failed to submit item %p, error %u.\n", item->result, error);
+        /* The caller still owns the item. */
+        if (item->finalization_callback)
+            IUnknown_Release(&item->IUnknown_iface);
+        return HRESULT_FROM_WIN32(error);
+    }
 
     TRACE("dispatched %p.\n", item->result);
+
+    return S_OK;
 }
 
 static const struct queue_ops pool_queue_ops =
@@ -412,21 +428,48 @@ static struct work_item * serial_queue_get_next(struct queue *queue, struct work
     return next_item;
 }
 
+/* Submits next_item and the items following it until one is accepted by the target queue. Items
+   that can't be submitted are unlinked and released, except for 'item', which is still owned
+   by the caller; the return value is the submission result for 'item'. Called with queue->cs held. */
+static HRESULT serial_queue_dispatch(struct queue *queue, struct work_item *next_item, struct work_item *item)
+{
+    struct work_item *failed_item;
+    struct queue *target_queue;
+    HRESULT hr, item_hr = S_OK;
+
+    while (next_item)
+    {
+        if (SUCCEEDED(hr = grab_queue(queue->target_queue, &target_queue))
+                && SUCCEEDED(hr = target_queue->ops->submit(target_queue, next_item)))
+            break;
+
+        WARN("Failed to submit item %p to queue %#x, hr %#x.\n", next_item->result, queue->target_queue, hr);
+
+        failed_item = next_item;
+        /* Chained serial queues have already detached the item on failure. */
+        if (failed_item->queue == queue)
+            list_remove(&failed_item->entry);
+        next_item = list_empty(&queue->pending_items) ? NULL :
+                LIST_ENTRY(list_head(&queue->pending_items), struct work_item, entry);
+        IUnknown_Release(&failed_item->IUnknown_iface);
+        if (failed_item == item)
+            item_hr = hr;
+        else
+            IUnknown_Release(&failed_item->IUnknown_iface);
+    }
+
+    return item_hr;
+}
+
 static void CALLBACK serial_queue_finalization_callback(PTP_CALLBACK_INSTANCE instance, void *user_data)
 {
     struct work_item *item = (struct work_item *)user_data, *next_item;
-    struct queue *target_queue, *queue = item->queue;
-    HRESULT hr;
+    struct queue *queue = item->queue;
 
     EnterCriticalSection(&queue->cs);
 
     if ((next_item = serial_queue_get_next(queue, item)))
-    {
-        if (SUCCEEDED(hr = grab_queue(queue->target_queue, &target_queue)))
-            target_queue->ops->submit(target_queue, next_item);
-        else
-            WARN("Failed to grab queue for id %#x, hr %#x.\n", queue->target_queue, hr);
-    }
+        serial_queue_dispatch(queue, next_item, NULL);
 
     LeaveCriticalSection(&queue->cs);
 
@@ -465,11 +508,10 @@ static struct work_item * serial_queue_is_ack_token(struct queue *queue, struct
     return NULL;
 }
 
-static void serial_queue_submit(struct queue *queue, struct work_item *item)
+static HRESULT serial_queue_submit(struct queue *queue, struct work_item *item)
 {
     struct work_item *head, *next_item = NULL;
-    struct queue *target_queue;
-    HRESULT hr;
+    HRESULT hr = S_OK;
 
     /* In reply mode queue will advance when 'reply_result' is invoked, in regular mode it will advance automatically,
        via finalization callback. */
@@ -507,14 +549,11 @@ static void serial_queue_submit(struct queue *queue, struct work_item *item)
     }
 
     if (next_item)
-    {
-        if (SUCCEEDED(hr = grab_queue(queue->target_queue, &target_queue)))
-            target_queue->ops->submit(target_queue, next_item);
-        else
-            WARN("Failed to grab queue for id %#x, hr %#x.\n", queue->target_queue, hr);
-    }
+        hr = serial_queue_dispatch(queue, next_item, item);
 
     LeaveCriticalSection(&queue->cs);
+
+    return hr;
 }
 
 static const struct queue_ops serial_queue_ops =
@@ -543,6 +582,14 @@ static ULONG WINAPI work_item_AddRef(IUnknown *iface)
     return InterlockedIncrement(&item->refcount);
 }
 
+static void free_cached_work_items(void)
+{
+    SLIST_ENTRY *entry;
+
+    while ((entry = InterlockedPopEntrySList(&free_work_items)))
+        heap_free(CONTAINING_RECORD(entry, struct work_item, free_entry));
+}
+
 static ULONG WINAPI work_item_Release(IUnknown *iface)
 {
     struct work_item *item = work_item_impl_from_IUnknown(iface);
@@ -553,7 +600,16 @@ static ULONG WINAPI work_item_Release(IUnknown *iface)
         if (item->reply_result)
             IRtwqAsyncResult_Release(item->reply_result);
         IRtwqAsyncResult_Release(item->result);
-        heap_free(item);
+        if (platform_lock > 0 && QueryDepthSList(&free_work_items) < MAX_FREE_WORK_ITEMS)
+        {
+            InterlockedPushEntrySList(&free_work_items, &item->free_entry);
+            /* The platform may have been shut down since the check above, in
+             * which case nothing would free the cached item anymore. */
+            if (platform_lock <= 0)
+                free_cached_work_items();
+        }
+        else
+            heap_free(item);
     }
 
     return refcount;
@@ -571,8 +627,15 @@ static struct work_item * alloc_work_item(struct queue *queue, LONG priority, IR
     RTWQASYNCRESULT *async_result = (RTWQASYNCRESULT *)result;
     DWORD flags = 0, queue_id = 0;
     struct work_item *item;
+    SLIST_ENTRY *entry;
 
-    item = heap_alloc_zero(sizeof(*item));
+    if ((entry = InterlockedPopEntrySList(&free_work_items)))
+    {
+        item = CONTAINING_RECORD(entry, struct work_item, free_entry);
+        memset(item, 0, sizeof(*item));
+    }
+    else if (!(item = heap_alloc_zero(sizeof(*item))))
+        return NULL;
 
     item->IUnknown_iface.lpVtbl = &work_item_vtbl;
     item->result = result;
@@ -671,13 +734,15 @@ static void shutdown_queue(struct queue *queue)
 static HRESULT queue_submit_item(struct queue *queue, LONG priority, IRtwqAsyncResult *result)
 {
     struct work_item *item;
+    HRESULT hr;
 
     if (!(item = alloc_work_item(queue, priority, result)))
         return E_OUTOFMEMORY;
 
-    queue->ops->submit(queue, item);
+    if (FAILED(hr = queue->ops->submit(queue, item)))
+        IUnknown_Release(&item->IUnknown_iface);
 
-    return S_OK;
+    return hr;
 }
 
 static HRESULT queue_put_work_item(DWORD queue_id, LONG priority, IRtwqAsyncResult *result)
@@ -1163,6 +1228,8 @@ static void shutdown_system_queues(void)
         shutdown_queue(&system_queues[i]);
     }
 
+    free_cached_work_items();
+
     if (FAILED(hr = CoDecrementMTAUsage(mta_cookie)))
         WARN("Failed to uninitialize MTA, hr %#x.\n", hr);
 
@@ -19,6 +19,8 @@
 #include <stdarg.h>
 #include <string.h>
 
+#define COBJMACROS
+
 #include "windef.h"
 #include "winbase.h"
 #include "rtworkq.h"
@@ -101,7 +103,145 @@ static void test_platform_init(void)
     ok(hr == S_OK, "Failed to shut down, hr %#x.\n", hr);
 }
 
+struct test_callback
+{
+    IRtwqAsyncCallback IRtwqAsyncCallback_iface;
+    LONG index;
+};
+
+static LONG invoke_count, invoke_total, next_index, out_of_order;
+static HANDLE invoke_done;
+
+static struct test_callback *impl_from_IRtwqAsyncCallback(IRtwqAsyncCallback *iface)
+{
+    return CONTAINING_RECORD(iface, struct test_callback, IRtwqAsyncCallback_iface);
+}
+
+static HRESULT WINAPI testcallback_QueryInterface(IRtwqAsyncCallback *iface, REFIID riid, void **obj)
+{
+    if (IsEqualIID(riid, &IID_IUnknown))
+    {
+        *obj = iface;
+        IRtwqAsyncCallback_AddRef(iface);
+        return S_OK;
+    }
+
+    *obj = NULL;
+    return E_NOINTERFACE;
+}
+
+static ULONG WINAPI testcallback_AddRef(IRtwqAsyncCallback *iface)
+{
+    return 2;
+}
+
+static ULONG WINAPI testcallback_Release(IRtwqAsyncCallback *iface)
+{
+    return 1;
+}
+
+static HRESULT WINAPI testcallback_GetParameters(IRtwqAsyncCallback *iface, DWORD *flags, DWORD *queue)
+{
+    return E_NOTIMPL;
+}
+
+static HRESULT WINAPI testcallback_Invoke(IRtwqAsyncCallback *iface, IRtwqAsyncResult *result)
+{
+    struct test_callback *callback = impl_from_IRtwqAsyncCallback(iface);
+
+    if (InterlockedIncrement(&next_index) - 1 != callback->index)
+        InterlockedIncrement(&out_of_order);
+    if (InterlockedIncrement(&invoke_count) == invoke_total)
+        SetEvent(invoke_done);
+    return S_OK;
+}
+
+static const IRtwqAsyncCallbackVtbl testcallbackvtbl =
+{
+    testcallback_QueryInterface,
+    testcallback_AddRef,
+    testcallback_Release,
+    testcallback_GetParameters,
+    testcallback_Invoke,
+};
+
+static void run_work_items(DWORD queue, struct test_callback *callbacks, unsigned int count)
+{
+    IRtwqAsyncResult *result;
+    unsigned int i;
+    HRESULT hr;
+    DWORD ret;
+
+    invoke_count = next_index = out_of_order = 0;
+    invoke_total = count;
+    ResetEvent(invoke_done);
+
+    for (i = 0; i < count; ++i)
+    {
+        hr = RtwqCreateAsyncResult(NULL, &callbacks[i].IRtwqAsyncCallback_iface, NULL, &result);
+        ok(hr == S_OK, "Failed to create result, hr %#x.\n", hr);
+        hr = RtwqPutWorkItem(queue, 0, result);
+        ok(hr == S_OK, "Failed to submit item %u, hr %#x.\n", i, hr);
+        IRtwqAsyncResult_Release(result);
+    }
+
+    ret = WaitForSingleObject(invoke_done, 5000);
+    ok(ret == WAIT_OBJECT_0, "Got unexpected wait result %#x.\n", ret);
+    ok(invoke_count == count, "Got %d invocations, expected %u.\n", invoke_count, count);
+}
+
+static void test_work_items(void)
+{
+    static const unsigned int count = 500;
+    struct test_callback *callbacks;
+    DWORD queue, serial_queue;
+    unsigned int i, round;
+    HRESULT hr;
+
+    invoke_done = CreateEventA(NULL, TRUE, FALSE, NULL);
+    callbacks = HeapAlloc(GetProcessHeap(), 0, count * sizeof(*callbacks));
+    for (i = 0; i < count; ++i)
+    {
+        callbacks[i].IRtwqAsyncCallback_iface.lpVtbl = &testcallbackvtbl;
+        callbacks[i].index = i;
+    }
+
+    /* The platform is restarted in between; the last items of the first run
+     * may only be released once it has been shut down. */
+    for (round = 0; round < 2; ++round)
+    {
+        hr = RtwqStartup();
+        ok(hr == S_OK, "Failed to start up, hr %#x.\n", hr);
+
+        hr = RtwqAllocateWorkQueue(RTWQ_MULTITHREADED_WORKQUEUE, &queue);
+        ok(hr == S_OK, "Failed to allocate a queue, hr %#x.\n", hr);
+
+        /* Enough items, submitted repeatedly, that work item objects get reused. */
+        for (i = 0; i < 4; ++i)
+            run_work_items(queue, callbacks, count);
+
+        /* Serial queues run items one at a time, in submission order, even on
+         * top of a multithreaded queue. */
+        hr = RtwqAllocateSerialWorkQueue(queue, &serial_queue);
+        ok(hr == S_OK, "Failed to allocate a serial queue, hr %#x.\n", hr);
+        run_work_items(serial_queue, callbacks, count);
+        ok(!out_of_order, "%d items were invoked out of order.\n", out_of_order);
+
+        hr = RtwqUnlockWorkQueue(serial_queue);
+        ok(hr == S_OK, "Failed to unlock the serial queue, hr %#x.\n", hr);
+        hr = RtwqUnlockWorkQueue(queue);
+        ok(hr == S_OK, "Failed to unlock the queue, hr %#x.\n", hr);
+
+        hr = RtwqShutdown();
+        ok(hr == S_OK, "Failed to shut down, hr %#x.\n", hr);
+    }
+
+    HeapFree(GetProcessHeap(), 0, callbacks);
+    CloseHandle(invoke_done);
+}
+
 START_TEST(rtworkq)
 {
     test_platform_init();
+    test_work_items();
 }
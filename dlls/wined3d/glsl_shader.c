@@ -42,6 +42,7 @@
 
 WINE_DEFAULT_DEBUG_CHANNEL(d3d_shader);
 WINE_DECLARE_DEBUG_CHANNEL(d3d);
+WINE_DECLARE_DEBUG_CHANNEL(d3d_perf);
 WINE_DECLARE_DEBUG_CHANNEL(winediag);
 
 #define WINED3D_GLSL_SAMPLE_PROJECTED   0x01
@@ -144,6 +145,22 @@ struct shader_glsl_priv
     struct wine_rb_tree ffp_fragment_shaders;
     BOOL ffp_proj_control;
     BOOL legacy_lighting;
+
+    struct
+    {
+        BOOL initialised;
+        BOOL enabled;
+        char *driver_id;
+        CRITICAL_SECTION cs;
+        struct wine_rb_tree entries;
+        HANDLE preload_thread;
+        BOOL cancel_preload;
+        unsigned int preload_count;
+        unsigned int hit_count;
+        unsigned int miss_count;
+        unsigned int reject_count;
+        unsigned int store_count;
+    } program_cache;
 };
 
 struct glsl_vs_program
@@ -642,6 +659,427 @@ void shader_glsl_validate_link(const struct wined3d_gl_info *gl_info, GLuint pro
     print_glsl_info_log(gl_info, program, TRUE);
 }
 
+#define WINED3D_PROGRAM_CACHE_MAGIC   0x50534c47 /* GLSP */
+#define WINED3D_PROGRAM_CACHE_VERSION 1
+/* Upper bound for the entries read ahead of time, in bytes. */
+#define WINED3D_PROGRAM_CACHE_PRELOAD_SIZE (64 * 1024 * 1024)
+
+/* Linked programs are stored in the directory given by the "ShaderCachePath"
+ * setting, one file per program. Entries are named after a hash of the key,
+ * which consists of the GL driver identification and the source of every
+ * shader attached to the program. The complete key is stored in the entry
+ * and compared on load.
+ *
+ * When the shader backend is created, a thread reads the existing entries
+ * into memory, so that linking a program only has to look the entry up.
+ * Entries the thread hasn't reached yet are read from disk on demand. */
+struct glsl_program_cache_header
+{
+    DWORD magic;
+    DWORD version;
+    DWORD key_size;
+    DWORD binary_format;
+    DWORD binary_size;
+};
+
+struct glsl_program_cache_key
+{
+    char *data;
+    SIZE_T size;
+    ULONG64 hash;
+};
+
+struct glsl_program_cache_entry
+{
+    struct wine_rb_entry entry;
+    ULONG64 hash;
+    DWORD key_size;
+    DWORD binary_format;
+    DWORD binary_size;
+    BYTE data[1]; /* The key, followed by the program binary. */
+};
+
+static int glsl_program_cache_entry_compare(const void *key, const struct wine_rb_entry *entry)
+{
+    const struct glsl_program_cache_entry *e = WINE_RB_ENTRY_VALUE(entry, struct glsl_program_cache_entry, entry);
+    ULONG64 hash = *(const ULONG64 *)key;
+
+    return hash < e->hash ? -1 : hash > e->hash;
+}
+
+static void glsl_program_cache_entry_free(struct wine_rb_entry *entry, void *context)
+{
+    heap_free(WINE_RB_ENTRY_VALUE(entry, struct glsl_program_cache_entry, entry));
+}
+
+static ULONG64 shader_glsl_program_cache_hash(const BYTE *data, SIZE_T size)
+{
+    ULONG64 hash = 0xcbf29ce484222325;
+    SIZE_T i;
+
+    for (i = 0; i < size; ++i)
+    {
+        hash ^= data[i];
+        hash *= 0x100000001b3;
+    }
+    return hash;
+}
+
+static struct glsl_program_cache_entry *shader_glsl_read_program_cache_entry(const char *path)
+{
+    struct glsl_program_cache_entry *entry = NULL;
+    struct glsl_program_cache_header header;
+    LARGE_INTEGER file_size;
+    HANDLE file;
+    DWORD read;
+    SIZE_T size;
+
+    file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, NULL,
+            OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+        return NULL;
+
+    if (!GetFileSizeEx(file, &file_size)
+            || !ReadFile(file, &header, sizeof(header), &read, NULL) || read != sizeof(header)
+            || header.magic != WINED3D_PROGRAM_CACHE_MAGIC || header.version != WINED3D_PROGRAM_CACHE_VERSION
+            || !header.key_size || !header.binary_size
+            || (ULONG64)file_size.QuadPart != sizeof(header) + (ULONG64)header.key_size + header.binary_size)
+    {
+        WARN("Ignoring invalid program cache entry %s.\n", debugstr_a(path));
+        goto done;
+    }
+
+    size = (SIZE_T)header.key_size + header.binary_size;
+    if (!(entry = heap_alloc(FIELD_OFFSET(struct glsl_program_cache_entry, data[size]))))
+        goto done;
+    if (!ReadFile(file, entry->data, size, &read, NULL) || read != size)
+    {
+        heap_free(entry);
+        entry = NULL;
+        goto done;
+    }
+
+    entry->hash = shader_glsl_program_cache_hash(entry->data, header.key_size);
+    entry->key_size = header.key_size;
+    entry->binary_format = header.binary_format;
+    entry->binary_size = header.binary_size;
+
+done:
+    CloseHandle(file);
+    return entry;
+}
+
+static DWORD WINAPI shader_glsl_preload_program_cache(void *ctx)
+{
+    struct shader_glsl_priv *priv = ctx;
+    struct glsl_program_cache_entry *entry;
+    char path[MAX_PATH];
+    WIN32_FIND_DATAA data;
+    SIZE_T total = 0;
+    HANDLE find;
+
+    snprintf(path, sizeof(path), "%s\\*", wined3d_settings.shader_cache_path);
+    if ((find = FindFirstFileA(path, &data)) == INVALID_HANDLE_VALUE)
+        return 0;
+
+    do
+    {
+        /* Skip temporary files and anything else that isn't an entry. */
+        if ((data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) || strlen(data.cFileName) != 16
+                || strspn(data.cFileName, "0123456789abcdef") != 16)
+            continue;
+        if (total + data.nFileSizeLow > WINED3D_PROGRAM_CACHE_PRELOAD_SIZE || data.nFileSizeHigh)
+            break;
+
+        snprintf(path, sizeof(path), "%s\\%.16s", wined3d_settings.shader_cache_path, data.cFileName);
+        if (!(entry = shader_glsl_read_program_cache_entry(path)))
+            continue;
+
+        EnterCriticalSection(&priv->program_cache.cs);
+        if (wine_rb_put(&priv->program_cache.entries, &entry->hash, &entry->entry) == -1)
+        {
+            heap_free(entry);
+        }
+        else
+        {
+            total += data.nFileSizeLow;
+            ++priv->program_cache.preload_count;
+        }
+        LeaveCriticalSection(&priv->program_cache.cs);
+    } while (!priv->program_cache.cancel_preload && FindNextFileA(find, &data));
+
+    FindClose(find);
+    TRACE("Read %u program cache entries, %lu bytes.\n", priv->program_cache.preload_count, total);
+    return 0;
+}
+
+static void shader_glsl_start_program_cache(const struct wined3d_gl_info *gl_info, struct shader_glsl_priv *priv)
+{
+    InitializeCriticalSection(&priv->program_cache.cs);
+    priv->program_cache.cs.DebugInfo->Spare[0] = (DWORD_PTR)(__FILE__ ": shader_glsl_priv.program_cache.cs");
+    wine_rb_init(&priv->program_cache.entries, glsl_program_cache_entry_compare);
+
+    if (!wined3d_settings.shader_cache_path || !gl_info->supported[ARB_GET_PROGRAM_BINARY])
+        return;
+
+    CreateDirectoryA(wined3d_settings.shader_cache_path, NULL);
+    if (!(priv->program_cache.preload_thread = CreateThread(NULL, 0,
+            shader_glsl_preload_program_cache, priv, 0, NULL)))
+        WARN("Failed to create the program cache thread, error %u.\n", GetLastError());
+}
+
+static void shader_glsl_stop_program_cache(struct shader_glsl_priv *priv)
+{
+    if (priv->program_cache.preload_thread)
+    {
+        priv->program_cache.cancel_preload = TRUE;
+        WaitForSingleObject(priv->program_cache.preload_thread, INFINITE);
+        CloseHandle(priv->program_cache.preload_thread);
+    }
+
+    if (priv->program_cache.enabled)
+        TRACE_(d3d_perf)("Program cache: %u entries read ahead, %u hits, %u misses, "
+                "%u binaries rejected by the driver, %u programs stored.\n",
+                priv->program_cache.preload_count, priv->program_cache.hit_count,
+                priv->program_cache.miss_count, priv->program_cache.reject_count,
+                priv->program_cache.store_count);
+
+    wine_rb_destroy(&priv->program_cache.entries, glsl_program_cache_entry_free, NULL);
+    priv->program_cache.cs.DebugInfo->Spare[0] = 0;
+    DeleteCriticalSection(&priv->program_cache.cs);
+    heap_free(priv->program_cache.driver_id);
+}
+
+/* Context activation is done by the caller. */
+static void shader_glsl_init_program_cache(const struct wined3d_gl_info *gl_info, struct shader_glsl_priv *priv)
+{
+    const char *vendor, *renderer, *version;
+    GLint format_count = 0;
+    SIZE_T size;
+
+    priv->program_cache.initialised = TRUE;
+
+    if (!wined3d_settings.shader_cache_path || !gl_info->supported[ARB_GET_PROGRAM_BINARY])
+        return;
+
+    gl_info->gl_ops.gl.p_glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &format_count);
+    if (!format_count)
+    {
+        WARN("No program binary formats supported, not using the program cache.\n");
+        return;
+    }
+
+    vendor = (const char *)gl_info->gl_ops.gl.p_glGetString(GL_VENDOR);
+    renderer = (const char *)gl_info->gl_ops.gl.p_glGetString(GL_RENDERER);
+    version = (const char *)gl_info->gl_ops.gl.p_glGetString(GL_VERSION);
+    if (!vendor || !renderer || !version)
+        return;
+
+    size = strlen(vendor) + strlen(renderer) + strlen(version) + 3;
+    if (!(priv->program_cache.driver_id = heap_alloc(size)))
+        return;
+    sprintf(priv->program_cache.driver_id, "%s\n%s\n%s", vendor, renderer, version);
+
+    priv->program_cache.enabled = TRUE;
+    TRACE("Using program cache directory %s.\n", debugstr_a(wined3d_settings.shader_cache_path));
+}
+
+/* Context activation is done by the caller. */
+static BOOL shader_glsl_init_program_cache_key(const struct wined3d_gl_info *gl_info,
+        const struct shader_glsl_priv *priv, GLuint program_id, struct glsl_program_cache_key *key)
+{
+    GLint i, shader_count, length;
+    SIZE_T size, driver_id_size;
+    GLuint *shaders;
+    char *ptr;
+
+    GL_EXTCALL(glGetProgramiv(program_id, GL_ATTACHED_SHADERS, &shader_count));
+    if (!(shaders = heap_calloc(shader_count, sizeof(*shaders))))
+        return FALSE;
+    GL_EXTCALL(glGetAttachedShaders(program_id, shader_count, NULL, shaders));
+
+    driver_id_size = strlen(priv->program_cache.driver_id) + 1;
+    size = driver_id_size;
+    for (i = 0; i < shader_count; ++i)
+    {
+        GL_EXTCALL(glGetShaderiv(shaders[i], GL_SHADER_SOURCE_LENGTH, &length));
+        size += length + 1;
+    }
+
+    if (!(key->data = heap_alloc_zero(size)))
+    {
+        heap_free(shaders);
+        return FALSE;
+    }
+
+    memcpy(key->data, priv->program_cache.driver_id, driver_id_size);
+    ptr = key->data + driver_id_size;
+    for (i = 0; i < shader_count; ++i)
+    {
+        GL_EXTCALL(glGetShaderSource(shaders[i], size - (ptr - key->data), &length, ptr));
+        ptr += length + 1;
+    }
+    heap_free(shaders);
+    checkGLcall("get program cache key");
+
+    key->size = ptr - key->data;
+    key->hash = shader_glsl_program_cache_hash((const BYTE *)key->data, key->size);
+    return TRUE;
+}
+
+static BOOL shader_glsl_get_program_cache_path(const struct glsl_program_cache_key *key, char *path, SIZE_T size)
+{
+    int len = snprintf(path, size, "%s\\%08x%08x", wined3d_settings.shader_cache_path,
+            (unsigned int)(key->hash >> 32), (unsigned int)key->hash);
+
+    if (len < 0 || len >= size)
+    {
+        WARN("Program cache path %s is too long.\n", debugstr_a(wined3d_settings.shader_cache_path));
+        return FALSE;
+    }
+    return TRUE;
+}
+
+/* Context activation is done by the caller. */
+static BOOL shader_glsl_load_program_binary(const struct wined3d_gl_info *gl_info,
+        struct shader_glsl_priv *priv, GLuint program_id, const struct glsl_program_cache_key *key)
+{
+    struct glsl_program_cache_entry *entry = NULL;
+    struct wine_rb_entry *rb_entry;
+    char path[MAX_PATH];
+    BOOL ret = FALSE;
+    GLint status;
+
+    /* Entries are only used once; a program that is linked again after
+     * having been destroyed reads its entry from disk. */
+    EnterCriticalSection(&priv->program_cache.cs);
+    if ((rb_entry = wine_rb_get(&priv->program_cache.entries, &key->hash)))
+    {
+        wine_rb_remove(&priv->program_cache.entries, rb_entry);
+        entry = WINE_RB_ENTRY_VALUE(rb_entry, struct glsl_program_cache_entry, entry);
+    }
+    LeaveCriticalSection(&priv->program_cache.cs);
+
+    if (!entry)
+    {
+        if (!shader_glsl_get_program_cache_path(key, path, sizeof(path))
+                || !(entry = shader_glsl_read_program_cache_entry(path)))
+            return FALSE;
+    }
+
+    if (entry->key_size != key->size || memcmp(entry->data, key->data, key->size))
+        goto done;
+
+    GL_EXTCALL(glProgramBinary(program_id, entry->binary_format, entry->data + entry->key_size, entry->binary_size));
+    GL_EXTCALL(glGetProgramiv(program_id, GL_LINK_STATUS, &status));
+    checkGLcall("glProgramBinary");
+    if (!status)
+    {
+        WARN("Failed to load the binary for program %u, relinking.\n", program_id);
+        ++priv->program_cache.reject_count;
+        goto done;
+    }
+
+    TRACE("Loaded program %u from the program cache.\n", program_id);
+    ret = TRUE;
+
+done:
+    heap_free(entry);
+    return ret;
+}
+
+/* Context activation is done by the caller. */
+static BOOL shader_glsl_store_program_binary(const struct wined3d_gl_info *gl_info,
+        GLuint program_id, const struct glsl_program_cache_key *key)
+{
+    char path[MAX_PATH], tmp_path[MAX_PATH + 32], *data;
+    struct glsl_program_cache_header header;
+    GLint status, length;
+    GLenum format;
+    DWORD written;
+    HANDLE file;
+    BOOL ret;
+
+    if (!shader_glsl_get_program_cache_path(key, path, sizeof(path)))
+        return FALSE;
+
+    GL_EXTCALL(glGetProgramiv(program_id, GL_LINK_STATUS, &status));
+    GL_EXTCALL(glGetProgramiv(program_id, GL_PROGRAM_BINARY_LENGTH, &length));
+    if (!status || length <= 0 || !(data = heap_alloc(length)))
+        return FALSE;
+    GL_EXTCALL(glGetProgramBinary(program_id, length, &length, &format, data));
+    checkGLcall("glGetProgramBinary");
+
+    header.magic = WINED3D_PROGRAM_CACHE_MAGIC;
+    header.version = WINED3D_PROGRAM_CACHE_VERSION;
+    header.key_size = key->size;
+    header.binary_format = format;
+    header.binary_size = length;
+
+    /* Write to a private file first, so that other processes never see a
+     * partially written entry. */
+    snprintf(tmp_path, sizeof(tmp_path), "%s.%x.tmp", path, GetCurrentProcessId());
+    file = CreateFileA(tmp_path, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        WARN("Failed to create %s, error %u.\n", debugstr_a(tmp_path), GetLastError());
+        heap_free(data);
+        return FALSE;
+    }
+
+    ret = WriteFile(file, &header, sizeof(header), &written, NULL) && written == sizeof(header)
+            && WriteFile(file, key->data, header.key_size, &written, NULL) && written == header.key_size
+            && WriteFile(file, data, header.binary_size, &written, NULL) && written == header.binary_size;
+    CloseHandle(file);
+    heap_free(data);
+
+    if (!ret || !MoveFileExA(tmp_path, path, MOVEFILE_REPLACE_EXISTING))
+    {
+        WARN("Failed to write %s, error %u.\n", debugstr_a(path), GetLastError());
+        DeleteFileA(tmp_path);
+        return FALSE;
+    }
+
+    TRACE("Stored program %u in %s.\n", program_id, debugstr_a(path));
+    return TRUE;
+}
+
+/* Context activation is done by the caller. */
+static void shader_glsl_link_program(const struct wined3d_gl_info *gl_info,
+        struct shader_glsl_priv *priv, GLuint program_id, BOOL use_cache)
+{
+    struct glsl_program_cache_key key;
+
+    if (!priv->program_cache.initialised)
+        shader_glsl_init_program_cache(gl_info, priv);
+
+    if (use_cache && priv->program_cache.enabled
+            && shader_glsl_init_program_cache_key(gl_info, priv, program_id, &key))
+    {
+        if (shader_glsl_load_program_binary(gl_info, priv, program_id, &key))
+        {
+            ++priv->program_cache.hit_count;
+            heap_free(key.data);
+            return;
+        }
+        ++priv->program_cache.miss_count;
+
+        GL_EXTCALL(glProgramParameteri(program_id, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE));
+        TRACE("Linking GLSL shader program %u.\n", program_id);
+        GL_EXTCALL(glLinkProgram(program_id));
+        shader_glsl_validate_link(gl_info, program_id);
+
+        if (shader_glsl_store_program_binary(gl_info, program_id, &key))
+            ++priv->program_cache.store_count;
+        heap_free(key.data);
+        return;
+    }
+
+    TRACE("Linking GLSL shader program %u.\n", program_id);
+    GL_EXTCALL(glLinkProgram(program_id));
+    shader_glsl_validate_link(gl_info, program_id);
+}
+
 static BOOL shader_glsl_use_layout_qualifier(const struct wined3d_gl_info *gl_info)
 {
     /* Layout qualifiers were introduced in GLSL 1.40. The Nvidia Legacy GPU
@@ -10102,9 +10540,7 @@ static HRESULT shader_glsl_compile_compute_shader(struct shader_glsl_priv *priv,
 
     list_add_head(&shader->linked_programs, &entry->cs.shader_entry);
 
-    TRACE("Linking GLSL shader program %u.\n", program_id);
-    GL_EXTCALL(glLinkProgram(program_id));
-    shader_glsl_validate_link(gl_info, program_id);
+    shader_glsl_link_program(gl_info, priv, program_id, TRUE);
 
     GL_EXTCALL(glUseProgram(program_id));
     checkGLcall("glUseProgram");
@@ -10431,10 +10867,9 @@ static void set_glsl_shader_program(const struct wined3d_context_gl *context_gl,
         list_add_head(ps_list, &entry->ps.shader_entry);
     }
 
-    /* Link the program */
-    TRACE("Linking GLSL shader program %u.\n", program_id);
-    GL_EXTCALL(glLinkProgram(program_id));
-    shader_glsl_validate_link(gl_info, program_id);
+    /* Link the program. Transform feedback varyings are not part of the
+     * program cache key, so such programs are always linked. */
+    shader_glsl_link_program(gl_info, priv, program_id, !gshader || !gshader->u.gs.so_desc.element_count);
 
     shader_glsl_init_vs_uniform_locations(gl_info, priv, program_id, &entry->vs,
             vshader ? vshader->limits->constant_float : 0);
@@ -11024,6 +11459,7 @@ static HRESULT shader_glsl_alloc(struct wined3d_device *device, const struct win
     }
 
     wine_rb_init(&priv->program_lookup, glsl_program_key_compare);
+    shader_glsl_start_program_cache(&device->adapter->gl_info, priv);
 
     priv->next_constant_version = 1;
     priv->vertex_pipe = vertex_pipe;
@@ -11054,6 +11490,7 @@ static void shader_glsl_free(struct wined3d_device *device, struct wined3d_conte
 {
     struct shader_glsl_priv *priv = device->shader_priv;
 
+    shader_glsl_stop_program_cache(priv);
     wine_rb_destroy(&priv->program_lookup, NULL, NULL);
     constant_heap_free(&priv->pconst_heap);
     constant_heap_free(&priv->vconst_heap);
@@ -419,6 +419,7 @@ struct wined3d_settings
     /* Memory tracking and object counting. */
     UINT64 emulated_textureram;
     char *logo;
+    char *shader_cache_path;
     unsigned int multisample_textures;
     unsigned int sample_count;
     BOOL check_float_constants;
@@ -64,6 +64,9 @@
 #ifdef HAVE_SYS_UIO_H
 # include <sys/uio.h>
 #endif
+#ifdef HAVE_SYS_SENDFILE_H
+# include <sys/sendfile.h>
+#endif
 #ifdef HAVE_SYS_SOCKET_H
 #include <sys/socket.h>
 #endif
@@ -532,6 +535,7 @@ struct ws2_transmitfile_async
     DWORD                 file_read;
     DWORD                 file_bytes;
     DWORD                 bytes_per_send;
+    BOOL                  use_sendfile;
     TRANSMIT_FILE_BUFFERS buffers;
     DWORD                 flags;
     LARGE_INTEGER         offset;
@@ -643,7 +647,9 @@ static int ws_protocol_info(SOCKET s, int unicode, WSAPROTOCOL_INFOW *buffer, in
 int WSAIOCTL_GetInterfaceCount(void);
 int WSAIOCTL_GetInterfaceName(int intNumber, char *intName);
 
-static void WS_AddCompletion( SOCKET sock, ULONG_PTR CompletionValue, NTSTATUS CompletionStatus, ULONG Information, BOOL force );
+static void WS_AddCompletion( SOCKET sock, ULONG_PTR CompletionValue, NTSTATUS CompletionStatus, ULONG Information,
+                              BOOL force, HANDLE event );
+static void WS_CompleteSyncIO( SOCKET sock, ULONG_PTR cvalue, NTSTATUS status, ULONG information, HANDLE event );
 
 #define MAP_OPTION(opt) { WS_##opt, opt }
 
@@ -2521,7 +2527,7 @@ static NTSTATUS WS2_async_accept_recv( void *user, IO_STATUS_BLOCK *iosb, NTSTAT
         return status;
 
     if (wsa->cvalue)
-        WS_AddCompletion( HANDLE2SOCKET(wsa->listen_socket), wsa->cvalue, iosb->u.Status, iosb->Information, TRUE );
+        WS_AddCompletion( HANDLE2SOCKET(wsa->listen_socket), wsa->cvalue, iosb->u.Status, iosb->Information, TRUE, 0 );
 
     release_async_io( &wsa->io );
     return status;
@@ -3064,6 +3070,65 @@ static NTSTATUS WS2_transmitfile_getbuffer( int fd, struct ws2_transmitfile_asyn
     return STATUS_SUCCESS;
 }
 
+#ifdef HAVE_SYS_SENDFILE_H
+/***********************************************************************
+ *     WS2_transmitfile_sendfile        (INTERNAL)
+ *
+ * Send the main file directly from its Unix fd, without copying it
+ * through a user-space buffer. Returns STATUS_NOT_SUPPORTED when the
+ * file has to be sent with the buffered path instead.
+ */
+static NTSTATUS WS2_transmitfile_sendfile( int fd, struct ws2_transmitfile_async *wsa )
+{
+    IO_STATUS_BLOCK *iosb = (IO_STATUS_BLOCK *)wsa->write.user_overlapped;
+    size_t count = wsa->file_bytes ? wsa->file_bytes - wsa->file_read : INT_MAX;
+    int file_fd, err;
+    off_t offset;
+    ssize_t n;
+
+    if (wine_server_handle_to_fd( wsa->file, FILE_READ_DATA, &file_fd, NULL ))
+        return STATUS_NOT_SUPPORTED;
+
+    if (wsa->offset.QuadPart == FILE_USE_FILE_POINTER_POSITION)
+        n = sendfile( fd, file_fd, NULL, count );
+    else
+    {
+        offset = wsa->offset.QuadPart;
+        n = sendfile( fd, file_fd, &offset, count );
+    }
+    err = errno;
+    wine_server_release_fd( wsa->file, file_fd );
+
+    if (n < 0)
+    {
+        if (err == EAGAIN || err == EINTR) return STATUS_PENDING;
+        if (err == EINVAL || err == ENOSYS)
+        {
+            /* not supported for this kind of file, use the buffered path */
+            wsa->use_sendfile = FALSE;
+            return STATUS_NOT_SUPPORTED;
+        }
+        errno = err;
+        return wsaErrStatus();
+    }
+
+    if (!n)
+    {
+        /* end of file, continue on to the footer */
+        wsa->file = NULL;
+        return STATUS_NOT_SUPPORTED;
+    }
+
+    if (iosb) iosb->Information += n;
+    if (wsa->offset.QuadPart != FILE_USE_FILE_POINTER_POSITION)
+        wsa->offset.QuadPart += n;
+    wsa->file_read += n;
+    if (wsa->file_bytes != 0 && wsa->file_read >= wsa->file_bytes)
+        wsa->file = NULL;
+    return STATUS_PENDING;
+}
+#endif
+
 /***********************************************************************
  *     WS2_transmitfile_base            (INTERNAL)
  *
@@ -3073,6 +3138,16 @@ static NTSTATUS WS2_transmitfile_base( int fd, struct ws2_transmitfile_async *ws
 {
     NTSTATUS status;
 
+#ifdef HAVE_SYS_SENDFILE_H
+    /* the header has to be fully sent before the file data */
+    if (wsa->use_sendfile && wsa->file && !wsa->buffers.Head &&
+        wsa->write.first_iovec >= wsa->write.n_iovecs)
+    {
+        status = WS2_transmitfile_sendfile( fd, wsa );
+        if (status != STATUS_NOT_SUPPORTED) return status;
+    }
+#endif
+
     status = WS2_transmitfile_getbuffer( fd, wsa );
     if (status == STATUS_PENDING)
     {
@@ -3176,6 +3251,7 @@ static BOOL WINAPI WS2_TransmitFile( SOCKET s, HANDLE h, DWORD file_bytes, DWORD
     wsa->file_read             = 0;
     wsa->file_bytes            = file_bytes;
     wsa->bytes_per_send        = bytes_per_send;
+    wsa->use_sendfile          = TRUE;
     wsa->flags                 = flags;
     wsa->offset.QuadPart       = FILE_USE_FILE_POINTER_POSITION;
     wsa->write.hSocket         = SOCKET2HANDLE(s);
@@ -3643,8 +3719,7 @@ static BOOL WINAPI WS2_ConnectEx(SOCKET s, const struct WS_sockaddr* name, int n
             {
                 ov->Internal = sock_error_to_ntstatus( get_sock_error( s, FD_CONNECT_BIT  ));
                 ov->InternalHigh = 0;
-                if (cvalue) WS_AddCompletion( s, cvalue, ov->Internal, ov->InternalHigh, FALSE );
-                if (ov->hEvent) NtSetEvent( ov->hEvent, NULL );
+                WS_CompleteSyncIO( s, cvalue, ov->Internal, ov->InternalHigh, ov->hEvent );
                 status = STATUS_PENDING;
             }
             SetLastError( NtStatusToWSAError(status) );
@@ -5132,8 +5207,7 @@ INT WINAPI WSAIoctl(SOCKET s, DWORD code, LPVOID in_buff, DWORD in_size, LPVOID
         ULONG_PTR cvalue = (overlapped && ((ULONG_PTR)overlapped->hEvent & 1) == 0) ? (ULONG_PTR)overlapped : 0;
         overlapped->Internal = sock_error_to_ntstatus( status );
         overlapped->InternalHigh = total;
-        if (cvalue) WS_AddCompletion( HANDLE2SOCKET(s), cvalue, overlapped->Internal, total, FALSE );
-        if (overlapped->hEvent) NtSetEvent( overlapped->hEvent, NULL );
+        WS_CompleteSyncIO( HANDLE2SOCKET(s), cvalue, overlapped->Internal, total, overlapped->hEvent );
     }
 
     if (!status)
@@ -5222,6 +5296,23 @@ int WINAPI WS_recvfrom(SOCKET s, char *buf, INT len, int flags,
         return n;
 }
 
+/* get the per-thread poll array, growing it if needed */
+static struct pollfd *get_poll_fds( struct per_thread_data *ptb, unsigned int count )
+{
+    struct pollfd *fds;
+
+    /* check if the cache can hold all descriptors, if not do the resizing */
+    if (ptb->fd_count < count)
+    {
+        if (!(fds = HeapAlloc(GetProcessHeap(), 0, count * sizeof(fds[0]))))
+            return NULL;
+        HeapFree(GetProcessHeap(), 0, ptb->fd_cache);
+        ptb->fd_cache = fds;
+        ptb->fd_count = count;
+    }
+    return ptb->fd_cache;
+}
+
 /* allocate a poll array for the corresponding fd sets */
 static struct pollfd *fd_sets_to_poll( const WS_fd_set *readfds, const WS_fd_set *writefds,
                                        const WS_fd_set *exceptfds, int *count_ptr )
@@ -5240,20 +5331,11 @@ static struct pollfd *fd_sets_to_poll( const WS_fd_set *readfds, const WS_fd_set
         return NULL;
     }
 
-    /* check if the cache can hold all descriptors, if not do the resizing */
-    if (ptb->fd_count < count)
+    if (!(fds = get_poll_fds( ptb, count )))
     {
-        if (!(fds = HeapAlloc(GetProcessHeap(), 0, count * sizeof(fds[0]))))
-        {
-            SetLastError( ERROR_NOT_ENOUGH_MEMORY );
-            return NULL;
-        }
-        HeapFree(GetProcessHeap(), 0, ptb->fd_cache);
-        ptb->fd_cache = fds;
-        ptb->fd_count = count;
+        SetLastError( ERROR_NOT_ENOUGH_MEMORY );
+        return NULL;
     }
-    else
-        fds = ptb->fd_cache;
 
     if (readfds)
         for (i = 0; i < readfds->fd_count; i++, j++)
@@ -5483,7 +5565,7 @@ int WINAPI WSAPoll(WSAPOLLFD *wfds, ULONG count, int timeout)
         return SOCKET_ERROR;
     }
 
-    if (!(ufds = HeapAlloc(GetProcessHeap(), 0, count * sizeof(ufds[0]))))
+    if (!(ufds = get_poll_fds( get_per_thread_data(), count )))
     {
         SetLastError(WSAENOBUFS);
         return SOCKET_ERROR;
@@ -5522,13 +5604,12 @@ int WINAPI WSAPoll(WSAPOLLFD *wfds, ULONG count, int timeout)
             wfds[i].revents = WS_POLLNVAL;
     }
 
-    HeapFree(GetProcessHeap(), 0, ufds);
     return ret;
 }
 
 /* helper to send completion messages for client-only i/o operation case */
 static void WS_AddCompletion( SOCKET sock, ULONG_PTR CompletionValue, NTSTATUS CompletionStatus,
-                              ULONG Information, BOOL async )
+                              ULONG Information, BOOL async, HANDLE event )
 {
     SERVER_START_REQ( add_fd_completion )
     {
@@ -5537,11 +5618,20 @@ static void WS_AddCompletion( SOCKET sock, ULONG_PTR CompletionValue, NTSTATUS C
         req->status      = CompletionStatus;
         req->information = Information;
         req->async       = async;
+        req->event       = wine_server_obj_handle( event );
         wine_server_call( req );
     }
     SERVER_END_REQ;
 }
 
+/* report an overlapped operation that completed without going through the server;
+ * the completion is queued and the event signaled with a single server call */
+static void WS_CompleteSyncIO( SOCKET sock, ULONG_PTR cvalue, NTSTATUS status, ULONG information, HANDLE event )
+{
+    if (cvalue) WS_AddCompletion( sock, cvalue, status, information, FALSE, event );
+    else if (event) NtSetEvent( event, NULL );
+}
+
 
 /***********************************************************************
  *		send			(WS2_32.19)
@@ -5681,8 +5771,7 @@ static int WS2_sendto( SOCKET s, LPWSABUF lpBuffers, DWORD dwBufferCount,
         if (lpNumberOfBytesSent) *lpNumberOfBytesSent = n;
         if (!wsa->completion_func)
         {
-            if (cvalue) WS_AddCompletion( s, cvalue, STATUS_SUCCESS, n, FALSE );
-            if (lpOverlapped->hEvent) SetEvent( lpOverlapped->hEvent );
+            WS_CompleteSyncIO( s, cvalue, STATUS_SUCCESS, n, lpOverlapped->hEvent );
             HeapFree( GetProcessHeap(), 0, wsa );
         }
         else NtQueueApcThread( GetCurrentThread(), (PNTAPCFUNC)ws2_async_apc,
@@ -8119,8 +8208,7 @@ static int WS2_recv_base( SOCKET s, LPWSABUF lpBuffers, DWORD dwBufferCount,
             iosb->Information = n;
             if (!wsa->completion_func)
             {
-                if (cvalue) WS_AddCompletion( s, cvalue, STATUS_SUCCESS, n, FALSE );
-                if (lpOverlapped->hEvent) SetEvent( lpOverlapped->hEvent );
+                WS_CompleteSyncIO( s, cvalue, STATUS_SUCCESS, n, lpOverlapped->hEvent );
                 HeapFree( GetProcessHeap(), 0, wsa );
             }
             else NtQueueApcThread( GetCurrentThread(), (PNTAPCFUNC)ws2_async_apc,
@@ -357,6 +357,16 @@ typedef struct
 } char_info_t;
 
 
+struct completion_msg
+{
+    apc_param_t   ckey;
+    apc_param_t   cvalue;
+    apc_param_t   information;
+    unsigned int  status;
+    int           __pad;
+};
+
+
 struct filesystem_event
 {
     int         action;
@@ -5444,11 +5454,7 @@ struct remove_completion_request
 struct remove_completion_reply
 {
     struct reply_header __header;
-    apc_param_t   ckey;
-    apc_param_t   cvalue;
-    apc_param_t   information;
-    unsigned int  status;
-    char __pad_36[4];
+    /* VARARG(msgs,completion_msgs); */
 };
 
 
@@ -5490,6 +5496,8 @@ struct add_fd_completion_request
     apc_param_t    information;
     unsigned int   status;
     int            async;
+    obj_handle_t   event;
+    char __pad_44[4];
 };
 struct add_fd_completion_reply
 {
@@ -6704,6 +6712,6 @@ union generic_reply
     struct resume_process_reply resume_process_reply;
 };
 
-#define SERVER_PROTOCOL_VERSION 595
+#define SERVER_PROTOCOL_VERSION 597
 
 #endif /* __WINE_WINE_SERVER_PROTOCOL_H */
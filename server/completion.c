@@ -214,28 +214,33 @@ DECL_HANDLER(add_completion)
     release_object( completion );
 }
 
-/* get completion from completion port */
+/* get completions from completion port */
 DECL_HANDLER(remove_completion)
 {
     struct completion* completion = get_completion_obj( current->process, req->handle, IO_COMPLETION_MODIFY_STATE );
-    struct list *entry;
+    struct completion_msg *msgs;
     struct comp_msg *msg;
+    data_size_t i, count;
 
     if (!completion) return;
 
-    entry = list_head( &completion->queue );
-    if (!entry)
+    count = min( completion->depth, get_reply_max_size() / sizeof(*msgs) );
+    if (!count)
         set_error( STATUS_PENDING );
-    else
+    else if ((msgs = set_reply_data_size( count * sizeof(*msgs) )))
     {
-        list_remove( entry );
-        completion->depth--;
-        msg = LIST_ENTRY( entry, struct comp_msg, queue_entry );
-        reply->ckey = msg->ckey;
-        reply->cvalue = msg->cvalue;
-        reply->status = msg->status;
-        reply->information = msg->information;
-        free( msg );
+        for (i = 0; i < count; i++)
+        {
+            msg = LIST_ENTRY( list_head( &completion->queue ), struct comp_msg, queue_entry );
+            list_remove( &msg->queue_entry );
+            completion->depth--;
+            msgs[i].ckey        = msg->ckey;
+            msgs[i].cvalue      = msg->cvalue;
+            msgs[i].information = msg->information;
+            msgs[i].status      = msg->status;
+            msgs[i].__pad       = 0;
+            free( msg );
+        }
     }
 
     release_object( completion );
@@ -2638,12 +2638,19 @@ DECL_HANDLER(set_completion_info)
 DECL_HANDLER(add_fd_completion)
 {
     struct fd *fd = get_handle_fd_obj( current->process, req->handle, 0 );
+    struct event *event;
+
     if (fd)
     {
         if (fd->completion && (req->async || !(fd->comp_flags & FILE_SKIP_COMPLETION_PORT_ON_SUCCESS)))
             add_completion( fd->completion, fd->comp_key, req->cvalue, req->status, req->information );
         release_object( fd );
     }
+    if (req->event && (event = get_event_obj( current->process, req->event, EVENT_MODIFY_STATE )))
+    {
+        set_event( event );
+        release_object( event );
+    }
 }
 
 /* set fd completion information */
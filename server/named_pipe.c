@@ -47,6 +47,7 @@ struct named_pipe;
 struct pipe_message
 {
     struct list          entry;      /* entry in message queue */
+    struct list          pending_entry; /* entry in pending writes list */
     data_size_t          read_pos;   /* already read bytes */
     struct iosb         *iosb;       /* message iosb */
     struct async        *async;      /* async of pending write */
@@ -64,6 +65,8 @@ struct pipe_end
     process_id_t         server_pid; /* process that created the server */
     data_size_t          buffer_size;/* size of buffered data that doesn't block caller */
     struct list          message_queue;
+    struct list          pending_writes; /* queued messages with a pending write async */
+    data_size_t          queued_size;/* size of unread data in message queue */
     struct async_queue   read_q;     /* read queue */
     struct async_queue   write_q;    /* write queue */
 };
@@ -359,7 +362,9 @@ static struct pipe_message *queue_message( struct pipe_end *pipe_end, struct ios
     message->iosb = (struct iosb *)grab_object( iosb );
     message->async = NULL;
     message->read_pos = 0;
+    list_init( &message->pending_entry );
     list_add_tail( &pipe_end->message_queue, &message->entry );
+    pipe_end->queued_size += iosb->in_size;
     return message;
 }
 
@@ -370,14 +375,18 @@ static void wake_message( struct pipe_message *message, data_size_t result )
     message->async = NULL;
     if (!async) return;
 
+    list_remove( &message->pending_entry );
+    list_init( &message->pending_entry );
     message->iosb->status = STATUS_SUCCESS;
     message->iosb->result = result;
     async_terminate( async, message->iosb->result ? STATUS_ALERTED : STATUS_SUCCESS );
     release_object( async );
 }
 
-static void free_message( struct pipe_message *message )
+static void free_message( struct pipe_end *pipe_end, struct pipe_message *message )
 {
+    pipe_end->queued_size -= message->iosb->in_size - message->read_pos;
+    list_remove( &message->pending_entry );
     list_remove( &message->entry );
     if (message->iosb) release_object( message->iosb );
     free( message );
@@ -398,7 +407,7 @@ static void pipe_end_disconnect( struct pipe_end *pipe_end, unsigned int status
     LIST_FOR_EACH_ENTRY_SAFE( message, next, &pipe_end->message_queue, struct pipe_message, entry )
     {
         async = message->async;
-        if (async || status == STATUS_PIPE_DISCONNECTED) free_message( message );
+        if (async || status == STATUS_PIPE_DISCONNECTED) free_message( pipe_end, message );
         if (!async) continue;
         async_terminate( async, status );
         release_object( async );
@@ -423,7 +432,7 @@ static void pipe_end_destroy( struct object *obj )
     {
         message = LIST_ENTRY( list_head(&pipe_end->message_queue), struct pipe_message, entry );
         assert( !message->async );
-        free_message( message );
+        free_message( pipe_end, message );
     }
 
     free_async_queue( &pipe_end->read_q );
@@ -734,13 +743,7 @@ static void message_queue_read( struct pipe_end *pipe_end, struct iosb *iosb )
     }
     else
     {
-        data_size_t avail = 0;
-        LIST_FOR_EACH_ENTRY( message, &pipe_end->message_queue, struct pipe_message, entry )
-        {
-            avail += message->iosb->in_size - message->read_pos;
-            if (avail >= iosb->out_size) break;
-        }
-        iosb->out_size = min( iosb->out_size, avail );
+        iosb->out_size = min( iosb->out_size, pipe_end->queued_size );
         iosb->status = STATUS_SUCCESS;
     }
 
@@ -750,7 +753,7 @@ static void message_queue_read( struct pipe_end *pipe_end, struct iosb *iosb )
         iosb->out_data = message->iosb->in_data;
         message->iosb->in_data = NULL;
         wake_message( message, message->iosb->in_size );
-        free_message( message );
+        free_message( pipe_end, message );
     }
     else
     {
@@ -771,10 +774,11 @@ static void message_queue_read( struct pipe_end *pipe_end, struct iosb *iosb )
             if (writing) memcpy( buf + write_pos, (const char *)message->iosb->in_data + message->read_pos, writing );
             write_pos += writing;
             message->read_pos += writing;
+            pipe_end->queued_size -= writing;
             if (message->read_pos == message->iosb->in_size)
             {
                 wake_message(message, message->iosb->in_size);
-                free_message(message);
+                free_message(pipe_end, message);
             }
         } while (write_pos < iosb->out_size);
     }
@@ -815,21 +819,40 @@ static void reselect_read_queue( struct pipe_end *pipe_end, int reselect_write )
 
 static void reselect_write_queue( struct pipe_end *pipe_end )
 {
-    struct pipe_message *message, *next;
+    struct pipe_message *message, *first;
     struct pipe_end *reader = pipe_end->connection;
+    struct list *ptr, *next;
     data_size_t avail = 0;
 
     if (!reader) return;
 
     ignore_reselect = 1;
 
-    LIST_FOR_EACH_ENTRY_SAFE( message, next, &reader->message_queue, struct pipe_message, entry )
+    if ((ptr = list_head( &reader->pending_writes )))
+    {
+        first = LIST_ENTRY( ptr, struct pipe_message, pending_entry );
+
+        /* messages queued before the first pending write only count for their size,
+         * which is the total minus the size of the messages from the first pending
+         * write to the tail; only that part of the queue is walked, twice */
+        avail = reader->queued_size;
+        LIST_FOR_EACH_ENTRY_REV( message, &reader->message_queue, struct pipe_message, entry )
+        {
+            avail -= message->iosb->in_size - message->read_pos;
+            if (message == first) break;
+        }
+        ptr = &first->entry;
+    }
+
+    for (; ptr; ptr = next)
     {
+        next = list_next( &reader->message_queue, ptr );
+        message = LIST_ENTRY( ptr, struct pipe_message, entry );
         if (message->async && message->iosb->status != STATUS_PENDING)
         {
             release_object( message->async );
             message->async = NULL;
-            free_message( message );
+            free_message( reader, message );
         }
         else
         {
@@ -841,7 +864,7 @@ static void reselect_write_queue( struct pipe_end *pipe_end )
             else if (message->async && (pipe_end->flags & NAMED_PIPE_NONBLOCKING_MODE))
             {
                 wake_message( message, message->read_pos );
-                free_message( message );
+                free_message( reader, message );
             }
         }
     }
@@ -910,6 +933,7 @@ static int pipe_end_write( struct fd *fd, struct async *async, file_pos_t pos )
     if (!message) return 0;
 
     message->async = (struct async *)grab_object( async );
+    list_add_tail( &pipe_end->connection->pending_writes, &message->pending_entry );
     queue_async( &pipe_end->write_q, async );
     reselect_read_queue( pipe_end->connection, 1 );
     set_error( STATUS_PENDING );
@@ -938,7 +962,7 @@ static int pipe_end_peek( struct pipe_end *pipe_end )
     unsigned reply_size = get_reply_max_size();
     FILE_PIPE_PEEK_BUFFER *buffer;
     struct pipe_message *message;
-    data_size_t avail = 0;
+    data_size_t avail;
     data_size_t message_length = 0;
 
     if (reply_size < offsetof( FILE_PIPE_PEEK_BUFFER, Data ))
@@ -961,8 +985,7 @@ static int pipe_end_peek( struct pipe_end *pipe_end )
         return 0;
     }
 
-    LIST_FOR_EACH_ENTRY( message, &pipe_end->message_queue, struct pipe_message, entry )
-        avail += message->iosb->in_size - message->read_pos;
+    avail = pipe_end->queued_size;
     reply_size = min( reply_size, avail );
 
     if (avail && pipe_end->pipe->message_mode)
@@ -1166,9 +1189,11 @@ static void init_pipe_end( struct pipe_end *pipe_end, struct named_pipe *pipe,
     pipe_end->flags = pipe_flags;
     pipe_end->connection = NULL;
     pipe_end->buffer_size = buffer_size;
+    pipe_end->queued_size = 0;
     init_async_queue( &pipe_end->read_q );
     init_async_queue( &pipe_end->write_q );
     list_init( &pipe_end->message_queue );
+    list_init( &pipe_end->pending_writes );
 }
 
 static struct pipe_server *create_pipe_server( struct named_pipe *pipe, unsigned int options,
@@ -2349,11 +2349,7 @@ C_ASSERT( FIELD_OFFSET(struct add_completion_request, status) == 40 );
 C_ASSERT( sizeof(struct add_completion_request) == 48 );
 C_ASSERT( FIELD_OFFSET(struct remove_completion_request, handle) == 12 );
 C_ASSERT( sizeof(struct remove_completion_request) == 16 );
-C_ASSERT( FIELD_OFFSET(struct remove_completion_reply, ckey) == 8 );
-C_ASSERT( FIELD_OFFSET(struct remove_completion_reply, cvalue) == 16 );
-C_ASSERT( FIELD_OFFSET(struct remove_completion_reply, information) == 24 );
-C_ASSERT( FIELD_OFFSET(struct remove_completion_reply, status) == 32 );
-C_ASSERT( sizeof(struct remove_completion_reply) == 40 );
+C_ASSERT( sizeof(struct remove_completion_reply) == 8 );
 C_ASSERT( FIELD_OFFSET(struct query_completion_request, handle) == 12 );
 C_ASSERT( sizeof(struct query_completion_request) == 16 );
 C_ASSERT( FIELD_OFFSET(struct query_completion_reply, depth) == 8 );
@@ -2367,7 +2363,8 @@ C_ASSERT( FIELD_OFFSET(struct add_fd_completion_request, cvalue) == 16 );
 C_ASSERT( FIELD_OFFSET(struct add_fd_completion_request, information) == 24 );
 C_ASSERT( FIELD_OFFSET(struct add_fd_completion_request, status) == 32 );
 C_ASSERT( FIELD_OFFSET(struct add_fd_completion_request, async) == 36 );
-C_ASSERT( sizeof(struct add_fd_completion_request) == 40 );
+C_ASSERT( FIELD_OFFSET(struct add_fd_completion_request, event) == 40 );
+C_ASSERT( sizeof(struct add_fd_completion_request) == 48 );
 C_ASSERT( FIELD_OFFSET(struct set_fd_completion_mode_request, handle) == 12 );
 C_ASSERT( FIELD_OFFSET(struct set_fd_completion_mode_request, flags) == 16 );
 C_ASSERT( sizeof(struct set_fd_completion_mode_request) == 24 );
@@ -1140,6 +1140,25 @@ static void dump_varargs_object_attributes( const char *prefix, data_size_t size
     fputc( '}', stderr );
 }
 
+static void dump_varargs_completion_msgs( const char *prefix, data_size_t size )
+{
+    const struct completion_msg *msg = cur_data;
+    data_size_t len = size / sizeof(*msg);
+
+    fprintf( stderr,"%s{", prefix );
+    while (len > 0)
+    {
+        dump_uint64( "{ckey=", &msg->ckey );
+        dump_uint64( ",cvalue=", &msg->cvalue );
+        dump_uint64( ",information=", &msg->information );
+        fprintf( stderr, ",status=%08x}", msg->status );
+        msg++;
+        if (--len) fputc( ',', stderr );
+    }
+    fputc( '}', stderr );
+    remove_data( size );
+}
+
 static void dump_varargs_filesystem_event( const char *prefix, data_size_t size )
 {
     static const char * const actions[] = {
@@ -4415,10 +4434,7 @@ static void dump_remove_completion_request( const struct remove_completion_reque
 
 static void dump_remove_completion_reply( const struct remove_completion_reply *req )
 {
-    dump_uint64( " ckey=", &req->ckey );
-    dump_uint64( ", cvalue=", &req->cvalue );
-    dump_uint64( ", information=", &req->information );
-    fprintf( stderr, ", status=%08x", req->status );
+    dump_varargs_completion_msgs( " msgs=", cur_size );
 }
 
 static void dump_query_completion_request( const struct query_completion_request *req )
@@ -4445,6 +4461,7 @@ static void dump_add_fd_completion_request( const struct add_fd_completion_reque
     dump_uint64( ", information=", &req->information );
     fprintf( stderr, ", status=%08x", req->status );
     fprintf( stderr, ", async=%d", req->async );
+    fprintf( stderr, ", event=%04x", req->event );
 }
 
 static void dump_set_fd_completion_mode_request( const struct set_fd_completion_mode_request *req )